@@ -0,0 +1,105 @@
+/*
+ * Rows of the character map, 032 to 128.  Included by Characters.h once for
+ * each orientation with GLYPH() moving the segments, so no include guard
+ */
+#if SEVENSEGMENT_FULL_CHARSET
+	GLYPH(B0000000), // 032 SPACE
+	GLYPH(B0110000), // 033 !
+	GLYPH(B0100010), // 034 "
+	GLYPH(B1000001), // 035 #
+	GLYPH(B1101101), // 036 $
+	GLYPH(B1010010), // 037 %
+	GLYPH(B1111100), // 038 &
+	GLYPH(B0100000), // 039 '
+	GLYPH(B0111001), // 040 (
+	GLYPH(B0001111), // 041 )
+	GLYPH(B0100001), // 042 *
+	GLYPH(B1110000), // 043 +
+	GLYPH(B0001000), // 044 ,
+#endif
+	GLYPH(B1000000), // 045 -
+	GLYPH(B0001000), // 046 .
+	GLYPH(B1010010), // 047 /
+	GLYPH(B0111111), // 048 0
+	GLYPH(B0000110), // 049 1
+	GLYPH(B1011011), // 050 2
+	GLYPH(B1001111), // 051 3
+	GLYPH(B1100110), // 052 4
+	GLYPH(B1101101), // 053 5
+	GLYPH(B1111101), // 054 6
+	GLYPH(B0000111), // 055 7
+	GLYPH(B1111111), // 056 8
+	GLYPH(B1101111), // 057 9
+#if SEVENSEGMENT_FULL_CHARSET
+	GLYPH(B1001000), // 058 :
+	GLYPH(B1001000), // 059 ;
+	GLYPH(B0111001), // 060 <
+	GLYPH(B1001000), // 061 =
+	GLYPH(B0001111), // 062 >
+	GLYPH(B1010011), // 063 ?
+	GLYPH(B1011111), // 064 @
+	GLYPH(B1110111), // 065 A
+	GLYPH(B1111100), // 066 B
+	GLYPH(B0111001), // 067 C
+	GLYPH(B1011110), // 068 D
+	GLYPH(B1111001), // 069 E
+	GLYPH(B1110001), // 070 F
+	GLYPH(B0111101), // 071 G
+	GLYPH(B1110110), // 072 H
+	GLYPH(B0000110), // 073 I
+	GLYPH(B0011110), // 074 J
+	GLYPH(B1110110), // 075 K
+	GLYPH(B0111000), // 076 L
+	GLYPH(B0010101), // 077 M
+	GLYPH(B0110111), // 078 N
+	GLYPH(B0111111), // 079 O
+	GLYPH(B1110011), // 080 P
+	GLYPH(B1100111), // 081 Q
+	GLYPH(B0110001), // 082 R
+	GLYPH(B1101101), // 083 S
+	GLYPH(B1111000), // 084 T
+	GLYPH(B0111110), // 085 U
+	GLYPH(B0011100), // 086 V
+	GLYPH(B0101010), // 087 W
+	GLYPH(B1110110), // 088 X
+	GLYPH(B1101110), // 089 Y
+	GLYPH(B1011011), // 090 Z
+	GLYPH(B0111001), // 091 [
+	GLYPH(B1100100), // 092 BACKSLASH (backslash character in code means line continuation)
+	GLYPH(B0001111), // 093 ]
+	GLYPH(B0100011), // 094 ^
+	GLYPH(B0001000), // 095 _
+	GLYPH(B0100000), // 096 `
+	GLYPH(B1110111), // 097 a
+	GLYPH(B1111100), // 098 b
+	GLYPH(B1011000), // 099 c
+	GLYPH(B1011110), // 100 d
+	GLYPH(B1111001), // 101 e
+	GLYPH(B1110001), // 102 f
+	GLYPH(B1101111), // 103 g
+	GLYPH(B1110100), // 104 h
+	GLYPH(B0000100), // 105 i
+	GLYPH(B0011110), // 106 j
+	GLYPH(B1110110), // 107 k
+	GLYPH(B0011000), // 108 l
+	GLYPH(B0010101), // 109 m
+	GLYPH(B1010100), // 110 n
+	GLYPH(B1011100), // 111 o
+	GLYPH(B1110011), // 112 p
+	GLYPH(B1100111), // 113 q
+	GLYPH(B1010000), // 114 r
+	GLYPH(B1101101), // 115 s
+	GLYPH(B1111000), // 116 t
+	GLYPH(B0111110), // 117 u
+	GLYPH(B0011100), // 118 v
+	GLYPH(B0101010), // 119 w
+	GLYPH(B1110110), // 120 x
+	GLYPH(B1101110), // 121 y
+	GLYPH(B1011011), // 122 z
+	GLYPH(B0111001), // 123 {
+	GLYPH(B0110000), // 124 |
+	GLYPH(B0001111), // 125 }
+	GLYPH(B1000000), // 126 ~
+	GLYPH(B0000000), // 127 DEL
+	GLYPH(B1100011)  // 128 Degree symbol
+#endif
@@ -12,108 +12,54 @@
  *   E|     |C
  *    |__D__|
  *
+ * The rows are in CharacterMap.h.  Only - . / and the digits are kept when
+ * SEVENSEGMENT_FULL_CHARSET is off, anything else shows as a blank
  */
 
+/*
+ * Segment moves for each orientation, usable on constants so the turned maps
+ * are worked out by the compiler
+ */
+#define SEGMENTS_ROTATED(b) (((b) & 0x40) | (((b) & 0x07) << 3) | (((b) & 0x38) >> 3)) // A-D B-E C-F
+#define SEGMENTS_MIRRORED(b) (((b) & 0x49) | (((b) & 0x02) << 4) | (((b) & 0x20) >> 4) | (((b) & 0x04) << 2) | (((b) & 0x10) >> 2)) // B-F C-E
+#define SEGMENTS_FLIPPED(b) (((b) & 0x40) | (((b) & 0x01) << 3) | (((b) & 0x08) >> 3) | (((b) & 0x12) << 1) | (((b) & 0x24) >> 1)) // A-D B-C E-F
+
 // Use this line for pre v1.0.5.8 (thanks by TomTheGeek) 
 //PROGMEM const prog_uchar segmentMap[] = {
 PROGMEM const unsigned char segmentMap[] = {
-	B0000000, // 032 SPACE
-	B0110000, // 033 !
-	B0100010, // 034 "
-	B1000001, // 035 #
-	B1101101, // 036 $
-	B1010010, // 037 %
-	B1111100, // 038 &
-	B0100000, // 039 '
-	B0111001, // 040 (
-	B0001111, // 041 )
-	B0100001, // 042 *
-	B1110000, // 043 +
-	B0001000, // 044 ,
-	B1000000, // 045 -
-	B0001000, // 046 .
-	B1010010, // 047 /
-	B0111111, // 048 0
-	B0000110, // 049 1
-	B1011011, // 050 2
-	B1001111, // 051 3
-	B1100110, // 052 4
-	B1101101, // 053 5
-	B1111101, // 054 6
-	B0000111, // 055 7
-	B1111111, // 056 8
-	B1101111, // 057 9
-	B1001000, // 058 :
-	B1001000, // 059 ;
-	B0111001, // 060 <
-	B1001000, // 061 =
-	B0001111, // 062 >
-	B1010011, // 063 ?
-	B1011111, // 064 @
-	B1110111, // 065 A
-	B1111100, // 066 B
-	B0111001, // 067 C
-	B1011110, // 068 D
-	B1111001, // 069 E
-	B1110001, // 070 F
-	B0111101, // 071 G
-	B1110110, // 072 H
-	B0000110, // 073 I
-	B0011110, // 074 J
-	B1110110, // 075 K
-	B0111000, // 076 L
-	B0010101, // 077 M
-	B0110111, // 078 N
-	B0111111, // 079 O
-	B1110011, // 080 P
-	B1100111, // 081 Q
-	B0110001, // 082 R
-	B1101101, // 083 S
-	B1111000, // 084 T
-	B0111110, // 085 U
-	B0011100, // 086 V
-	B0101010, // 087 W
-	B1110110, // 088 X
-	B1101110, // 089 Y
-	B1011011, // 090 Z
-	B0111001, // 091 [
-	B1100100, // 092 BACKSLASH (backslash character in code means line continuation)
-	B0001111, // 093 ]
-	B0100011, // 094 ^
-	B0001000, // 095 _
-	B0100000, // 096 `
-	B1110111, // 097 a
-	B1111100, // 098 b
-	B1011000, // 099 c
-	B1011110, // 100 d
-	B1111001, // 101 e
-	B1110001, // 102 f
-	B1101111, // 103 g
-	B1110100, // 104 h
-	B0000100, // 105 i
-	B0011110, // 106 j
-	B1110110, // 107 k
-	B0011000, // 108 l
-	B0010101, // 109 m
-	B1010100, // 110 n
-	B1011100, // 111 o
-	B1110011, // 112 p
-	B1100111, // 113 q
-	B1010000, // 114 r
-	B1101101, // 115 s
-	B1111000, // 116 t
-	B0111110, // 117 u
-	B0011100, // 118 v
-	B0101010, // 119 w
-	B1110110, // 120 x
-	B1101110, // 121 y
-	B1011011, // 122 z
-	B0111001, // 123 {
-	B0110000, // 124 |
-	B0001111, // 125 }
-	B1000000, // 126 ~
-	B0000000, // 127 DEL
-	B1100011  // 128 Degree symbol
+#define GLYPH(b) b
+#include "CharacterMap.h"
+#undef GLYPH
+};
+
+#if SEVENSEGMENT_ORIENTATION
+PROGMEM const unsigned char segmentMapRotated[] = {
+#define GLYPH(b) SEGMENTS_ROTATED(b)
+#include "CharacterMap.h"
+#undef GLYPH
+};
+
+PROGMEM const unsigned char segmentMapMirrored[] = {
+#define GLYPH(b) SEGMENTS_MIRRORED(b)
+#include "CharacterMap.h"
+#undef GLYPH
 };
 
+PROGMEM const unsigned char segmentMapFlipped[] = {
+#define GLYPH(b) SEGMENTS_FLIPPED(b)
+#include "CharacterMap.h"
+#undef GLYPH
+};
+
+/*
+ * Character maps in orientation_t order
+ */
+const unsigned char* const segmentMaps[] PROGMEM = {
+	segmentMap,
+	segmentMapRotated,
+	segmentMapMirrored,
+	segmentMapFlipped
+};
+#endif
+
 #endif
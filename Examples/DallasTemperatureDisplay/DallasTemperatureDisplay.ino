@@ -28,7 +28,6 @@
 
 */
 
-#include <stdlib.h>       // Double to long conversion
 #include <OneWire.h>
 #include <DallasTemperature.h>
 #include <SevenSegment.h>
@@ -53,25 +52,25 @@ void setup(){
 
 	// Set display driver AY0438 and screen definition
 	screen.begin("AY0438","8.8|8.8");
+	screen.setAlignment(RIGHT);
 
+	// Only change the screen when the temperature moves more than 0.1C, at
+	// most every 2 seconds, smoothing each reading by a quarter
+	screen.setFilter(1, 2000);
+	screen.setSmoothing(SMOOTH_EMA, 2);
 }
 
 void loop(){
 
-	// Temperature string
-	char temp[8];
-
 	// Retrieve temperature
 	sensors.requestTemperatures();
 
-	// Convert temperature to string with 1 decimal place
-	dtostrf(sensors.getTempC(thermometerAddress), 0, 1, temp);
-
-	// Print temperature
-	screen.print(temp);
+	// Print temperature in tenths with 1 decimal place, the screen is only
+	// redrawn and sent when the shown value has to change
+	screen.printFiltered(round(sensors.getTempC(thermometerAddress) * 10), 1);
 
 	// Wait a bit
-	delay(500);
+	delay(100);
 }
 
 
@@ -45,6 +45,7 @@ void loop(){
 	printText();
 	scrollingText();
 	printAnimation();
+	levelMeter();
 	randomSegments();
 }
 
@@ -189,6 +190,37 @@ void printAnimation(){
 	screen.clear();
 }
 
+// Sweep a level meter up and down the bottom, right and top of the screen
+void levelMeter(){
+
+	// Segments in the order they light, positions as in the screen definition
+	static uint8_t meter[] = {
+		BAR_SEGMENT(0, SEG_E), BAR_SEGMENT(0, SEG_D), BAR_SEGMENT(2, SEG_D),
+		BAR_SEGMENT(4, SEG_D), BAR_SEGMENT(6, SEG_D), BAR_SEGMENT(6, SEG_C),
+		BAR_SEGMENT(6, SEG_B), BAR_SEGMENT(6, SEG_A), BAR_SEGMENT(4, SEG_A),
+		BAR_SEGMENT(2, SEG_A), BAR_SEGMENT(0, SEG_A), BAR_SEGMENT(0, SEG_F)
+	};
+
+	screen.clear();
+	if (!screen.setBarGraph(meter, sizeof meter)){
+		return;
+	}
+
+	for (int t = 0; t < FEATURE_COUNT; t++){
+		for (int v = 0; v <= 1023; v += 32){
+			screen.setBarValue(v, 1023);
+			screen.display();
+			delay(WAIT / 4);
+		}
+		for (int v = 1023; v >= 0; v -= 32){
+			screen.setBarValue(v, 1023);
+			screen.display();
+			delay(WAIT / 4);
+		}
+	}
+	screen.clear();
+}
+
 // Toggle random segments on and off
 void randomSegments(){
 	for (int t = 0; t < 100; t++){
@@ -69,7 +69,7 @@ void setup(){
 	// Set display driver AY0438 and screen definition
 	screen.begin("AY0438","8.8|8.8");
 
-	screen.print("Load");
+	screen.print(F("Load"));
 
 	// Begin our networking
 	Ethernet.begin(mac,ip);
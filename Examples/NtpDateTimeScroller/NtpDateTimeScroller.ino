@@ -67,7 +67,7 @@ void setup(){
 	// Set display driver AY0438 and screen definition
 	screen.begin("AY0438","8.8|8.8");
 
-	screen.print("Load");
+	screen.print(F("Load"));
 
 	// Begin our networking
 	Ethernet.begin(mac,ip);
@@ -79,6 +79,9 @@ void setup(){
 
 	// Wait until we have a time!
 	while(timeStatus() == timeNotSet);
+
+	// Flash the colon (mask position 3) on and off every second
+	screen.setBlinkRate(1000);
 }
 
 
@@ -86,9 +89,15 @@ void loop(){
 
 	int count = 0;
 
+	// Blink the colon while the clock is shown
+	screen.setBlink(3, true);
+
 	// Display a clock for 10 seconds
 	while (count < 10){
 
+		// Let the library flash the colon
+		screen.update();
+
 		// update the display only if the time has changed (every second)
 		if (now() != prevDisplay) {
 			prevDisplay = now();
@@ -97,6 +106,9 @@ void loop(){
 		}
 	}
 
+	// Scrolling text shouldn't blink
+	screen.clearBlink();
+
 	// Scroll the current date by incrementing a pointer ;p
 	char* buf = getScrollingMessage();
 
@@ -127,20 +139,13 @@ char* getScrollingMessage(){
 // Display the time!
 void digitalClockDisplay(){
 
-	static boolean showColon;
 	static char buf[9];
 
-	// Create time string, display a colon or not?
-	if (!showColon)
-		sprintf(buf, "%02d%02d\0", hour(), minute());
-	else
-		sprintf(buf, "%02d:%02d\0", hour(), minute());
+	// Create time string, the library blinks the colon
+	sprintf(buf, "%02d:%02d\0", hour(), minute());
 
 	// Display the time on our screen
 	screen.print(buf);
-
-	// Toggle display of colon
-	showColon = !showColon;
 }
 
 // Retrieve NTP time
@@ -19,34 +19,24 @@
 
 SevenSegment screen(CLOCK, DATA, LOAD);
 
-uint16_t counter = 0;
-
 void setup(){
 
 	// Set display driver AY0438 and screen definition
 	screen.begin("AY0438","8.8|8.8");
 
+	// Show the colon, the counter only changes the digits
+	screen.setZeroPadding(true);
+	screen.print("00:00");
+	screen.setCounter(0);
 }
 
 void loop(){
 
-	// String to print
-	static char buf[8];
-
-	// Convert count to string
-	sprintf(buf, "%04d\0", counter);
-
-	// Insert colon into string
-	buf[5] = buf[4];
-	buf[4] = buf[3];
-	buf[3] = buf[2];
-	buf[2] = ':';
+	// Count up, only the digits that change are redrawn
+	screen.increment();
 
 	// Display
-	screen.print(buf);
-
-	// Increment counter
-	counter++;
+	screen.display();
 
 	// Wait a bit
 	delay(100);
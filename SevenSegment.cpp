@@ -23,6 +23,33 @@
 #include <avr/pgmspace.h> // Flash memory functions
 #include "Characters.h" // Character map
 
+/*
+ * Interrupt safe blocks, no return or break inside them.  AVR saves and
+ * restores the interrupt flag, other boards turn interrupts off for the
+ * block and back on after the outermost one
+ */
+#ifdef __AVR__
+  #include <util/atomic.h>
+  #define SEVENSEGMENT_ATOMIC ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#else
+static volatile uint8_t atomicDepth = 0;
+
+static inline uint8_t atomicStart(){
+	noInterrupts();
+	atomicDepth++;
+	return 1;
+}
+
+static inline uint8_t atomicEnd(){
+	if (--atomicDepth == 0){
+		interrupts();
+	}
+	return 0;
+}
+
+  #define SEVENSEGMENT_ATOMIC for (uint8_t atomicOnce = atomicStart(); atomicOnce; atomicOnce = atomicEnd())
+#endif
+
  /*
 
  Timing Diagram for AY0438
@@ -44,43 +71,131 @@
 */
 
 /*
- * LCD/LED Driver structure
+ * Driver names stored in program memory, left out when begin() by name is
+ * compiled out
  */
-struct driver {
-	char* name;
-	uint8_t segments;
-	boolean pulseLoad;
-	boolean segmentsOrderInc;
-	boolean initialBit;
-	boolean cascadable;
-	boolean dataEnable;
-}
-_device;
+#if SEVENSEGMENT_DRIVER_NAMES
+  #define DRIVER_NAME(name, text) const char name[] PROGMEM = text;
+  #define DRIVER_NAME_OF(name) name
+#else
+  #define DRIVER_NAME(name, text)
+  #define DRIVER_NAME_OF(name) NULL
+#endif
 
 /*
- * Table of supported drivers stored in program memory
+ * Supported drivers stored in program memory.  Timings (ns) are the
+ * datasheet minimums: M545x 0.5MHz clock, 300ns set-up; MM545x 300ns set-up
+ * and hold; the AY0438 sheet is a scan so it gets the same conservative
+ * figures with a 1us load pulse
  */
-PROGMEM const driver driverTable[] = {
-	{ "M5450", 35, false, true, true, false, false },
-	{ "M5451", 35, false, true, true, false, false },
-	{ "MM5452", 32, false, true, true, false, true },
-	{ "MM5453", 33, false, true, true, false, false },
-	{ "AY0438", 32, true, false, false, true, false },
-	{ "BT-M512RD-DR1", 35, false, true, true, false, true }
-};
+#if SEVENSEGMENT_DRIVER_M5450
+DRIVER_NAME(nameM5450, "M5450")
+const driver_t driverM5450 PROGMEM = { DRIVER_NAME_OF(nameM5450), 35, LATCH_NONE, true, false, false, 1, 1, 950, 300, 100, 0 };
+#endif
+#if SEVENSEGMENT_DRIVER_M5451
+DRIVER_NAME(nameM5451, "M5451")
+const driver_t driverM5451 PROGMEM = { DRIVER_NAME_OF(nameM5451), 35, LATCH_NONE, true, false, false, 1, 1, 950, 300, 100, 0 };
+#endif
+#if SEVENSEGMENT_DRIVER_MM5452
+DRIVER_NAME(nameMM5452, "MM5452")
+const driver_t driverMM5452 PROGMEM = { DRIVER_NAME_OF(nameMM5452), 32, LATCH_ENABLE, true, false, false, 1, 1, 950, 300, 300, 0 };
+#endif
+#if SEVENSEGMENT_DRIVER_MM5453
+DRIVER_NAME(nameMM5453, "MM5453")
+const driver_t driverMM5453 PROGMEM = { DRIVER_NAME_OF(nameMM5453), 33, LATCH_NONE, true, false, false, 1, 1, 950, 300, 300, 0 };
+#endif
+#if SEVENSEGMENT_DRIVER_AY0438
+DRIVER_NAME(nameAY0438, "AY0438")
+const driver_t driverAY0438 PROGMEM = { DRIVER_NAME_OF(nameAY0438), 32, LATCH_PULSE, false, true, false, 0, 0, 1000, 300, 300, 1000 };
+#endif
+#if SEVENSEGMENT_DRIVER_BT_M512RD_DR1
+DRIVER_NAME(nameBTM512RDDR1, "BT-M512RD-DR1")
+const driver_t driverBTM512RDDR1 PROGMEM = { DRIVER_NAME_OF(nameBTM512RDDR1), 35, LATCH_ENABLE, true, false, false, 1, 1, 950, 300, 100, 0 };
+#endif
 
-// Driver table reference
-driver* pDriverTable = (driver*) &driverTable;
+/*
+ * Table of built in drivers in driver_id_t order, NULL where compiled out
+ */
+const driver_t* const driverTable[DRIVER_COUNT] PROGMEM = {
+#if SEVENSEGMENT_DRIVER_M5450
+	&driverM5450,
+#else
+	NULL,
+#endif
+#if SEVENSEGMENT_DRIVER_M5451
+	&driverM5451,
+#else
+	NULL,
+#endif
+#if SEVENSEGMENT_DRIVER_MM5452
+	&driverMM5452,
+#else
+	NULL,
+#endif
+#if SEVENSEGMENT_DRIVER_MM5453
+	&driverMM5453,
+#else
+	NULL,
+#endif
+#if SEVENSEGMENT_DRIVER_AY0438
+	&driverAY0438,
+#else
+	NULL,
+#endif
+#if SEVENSEGMENT_DRIVER_BT_M512RD_DR1
+	&driverBTM512RDDR1
+#else
+	NULL
+#endif
+};
 
-#define NUMBER_LENGTH 4  // Number of digits in a number
-#define DRIVER_COUNT (sizeof(driverTable)/sizeof(driver)) // Number of driver chips supported
+#define NUMBER_LENGTH 10  // Maximum number of digits in a 32 bit number
 #define MASK_COUNT 32 // Number of digits, symbols supported by screen mask
 
+#define FRAME_BYTES 8 // 64 segments packed 8 to a byte
+#define FRAME_SEGMENTS 64 // Most segments the screen data can hold
+#define DEFAULT_BLINK_RATE 500 // Milliseconds blinking segments stay on, then off
+
+#define MAXIMUM_UNSIGNED 4294967295UL // Largest value printNumber(uint32_t) can show
+#define MAXIMUM_SIGNED 2147483647L // Largest magnitude printNumber(int32_t) can show
+#define SMOOTHING_SAMPLES 8 // Most readings SMOOTH_AVERAGE can average
+#define SMOOTHING_SHIFT 8 // Heaviest SMOOTH_EMA weighting, 1/256 per reading
+
+#define NO_PIN 255 // Load pin not connected
+#define RESERVED_CHAR '#' // Mask character seen at a reserved position
+#define CALIBRATION_WRITES 32 // digitalWrite()s timed to find how long one takes
+#define CALIBRATION_TIME 1000 // Microseconds the delay loop must run for to be timed
+#define CALIBRATION_SAMPLES 4 // Timings taken, the quickest is used
+
+#ifdef __AVR__
+  #define MICROS_STEP (64 / clockCyclesPerMicrosecond()) // micros() counts every 64 clock cycles
+#else
+  #define MICROS_STEP 1
+#endif
+
+#define TRACE_CLOCK 0 // Trace entries: line in bits 0-1, level in bit 2
+#define TRACE_DATA 1
+#define TRACE_LOAD 2
+#define TRACE_START 3 // Start of a transfer
+#define TRACE_HIGH 4
+
+// Bus pins are written through the trace when it is compiled in
+#if SEVENSEGMENT_TRACE
+  #define WRITE_PIN(line, pin, level) writePin(line, pin, level)
+#else
+  #define WRITE_PIN(line, pin, level) digitalWrite(pin, level)
+#endif
+
 #define SERIAL_MESSAGES_ON 0  // Debug messages On/off
 #define SERIAL_BAUD 9600  // Serial baud rate
 
+#if SEVENSEGMENT_FULL_CHARSET
 #define FIRST_CHARACTER 32 // ASCII value of first character defined in segment mapping array
 #define LAST_CHARACTER 128 // ASCII value of last character defined in segment mapping array
+#else
+#define FIRST_CHARACTER 45 // Digits only map starts at -
+#define LAST_CHARACTER 57 // and ends at 9
+#endif
 
 /*
  * Display constructor
@@ -89,6 +204,7 @@ SevenSegment::SevenSegment(uint8_t clock, uint8_t data) {
 
 	_pinClock = clock;
 	_pinData = data;
+	_pinLoad = NO_PIN;
 
 	pinMode(_pinClock, OUTPUT);
 	pinMode(_pinData, OUTPUT);
@@ -108,76 +224,142 @@ SevenSegment::SevenSegment(uint8_t clock, uint8_t data, uint8_t load) {
 	pinMode(_pinLoad, OUTPUT);
 }
 
+#if SEVENSEGMENT_DRIVER_NAMES
 /*
- * Initialise LCD using specified driver chip and with specified screen configuartion
+ * Initialise LCD using the named driver chip and with specified screen configuartion
  */
-boolean SevenSegment::begin(const char* driverName, const char* screenMask ){
+boolean SevenSegment::begin(const char* driverName, const char* screenMask){
 
-	// Temp buffer
-	char buffer[12];
+	const driver_t* driver;
 
-	// Loop through driver table and find relevant driver
-	for (uint8_t i=0; i < DRIVER_COUNT; i++){
+	// Loop through driver table and find relevant driver.  Compared straight
+	// from flash as the names are stored there
+	for (uint8_t i = 0; i < DRIVER_COUNT; i++){
+		driver = (const driver_t*) pgm_read_ptr(&driverTable[i]);
+		if (driver != NULL && strcmp_P(driverName, (const char*) pgm_read_ptr(&(driver->name))) == 0){
+			return begin(driver, screenMask);
+		}
+	}
+
+#if SERIAL_MESSAGES_ON > 0
+	Serial.print("Could not find display driver!");
+#endif
+
+	// Could not find the specified driver :(
+	_setupError = SETUP_UNKNOWN_DRIVER;
+	_setupErrorPosition = -1;
+	return false;
+}
+#endif
+
+/*
+ * Initialise LCD using a built in driver chip and with specified screen configuartion
+ */
+boolean SevenSegment::begin(driver_id_t driver, const char* screenMask){
 
-		// Copy driver name to temp buffer
-		strcpy(buffer, (char*) pgm_read_word(&(pDriverTable[i].name)));
+	const driver_t* device = NULL;
+
+	if (driver < DRIVER_COUNT){
+		device = (const driver_t*) pgm_read_ptr(&driverTable[driver]);
+	}
 
-		// Is this driver the one specified?
-		if (strcmp(buffer, driverName)==0){
+	// Unknown or compiled out
+	if (device == NULL){
+		_setupError = SETUP_UNKNOWN_DRIVER;
+		_setupErrorPosition = -1;
+		return false;
+	}
+	return begin(device, screenMask);
+}
 
-			// Copy driver data into the struct in main memory
-			_device.name = (char*) pgm_read_word(&(pDriverTable[i].name));
-			_device.segments = (uint8_t) pgm_read_byte(&(pDriverTable[i].segments));
-			_device.pulseLoad = (boolean) pgm_read_byte(&(pDriverTable[i].pulseLoad));
-			_device.segmentsOrderInc = (boolean) pgm_read_byte(&(pDriverTable[i].segmentsOrderInc));
-			_device.initialBit = (boolean) pgm_read_byte(&(pDriverTable[i].initialBit));
-			_device.cascadable = (boolean) pgm_read_byte(&(pDriverTable[i].cascadable));
+/*
+ * Initialise LCD using a driver described in program memory and with specified screen configuartion
+ */
+boolean SevenSegment::begin(const driver_t* driver, const char* screenMask){
 
-			// Store screen mask
-			strcpy(_mask, screenMask);
+	// Copy driver data into main memory
+	memcpy_P(&_device, driver, sizeof _device);
 
-			// Calculate over/underflow values
-			boolean maskValid = calculateDisplayRange();
+	// Validate and store screen mask, calculate over/underflow values
+	boolean maskValid = calculateDisplayRange(screenMask);
 
 #if SERIAL_MESSAGES_ON > 0
-			Serial.print("Driver found: ");
-			Serial.println(_device.name);
-			if (maskValid){
-				Serial.print("Maximum value supported: ");
-				Serial.println(_overflow);
-				Serial.print("Minimum value supported: ");
-				Serial.println(_underflow);
-			}
-			else {
-				Serial.println("Mask invalid!");
-			}
+#if SEVENSEGMENT_DRIVER_NAMES
+	Serial.print("Driver: ");
+	Serial.println((const __FlashStringHelper*) _device.name);
+#endif
+	if (maskValid){
+		Serial.print("Maximum value supported: ");
+		Serial.println(_overflow);
+		Serial.print("Minimum value supported: ");
+		Serial.println(_underflow);
+	}
+	else {
+		Serial.print("Mask invalid! Error ");
+		Serial.print(_setupError);
+		Serial.print(" at position ");
+		Serial.println(_setupErrorPosition);
+	}
 #endif
-			// If mask is valid then setup defaults
-			if (maskValid){
 
-				_wiring = LEFT_TO_RIGHT;
-				_maskCursor = 0;
-				_alignment = LEFT;
-				_zeroPadding = false;
-				clear();
+	// If mask is invalid there's nothing more to do
+	if (!maskValid){
+		return false;
+	}
 
-				return true;
-			}
-			else{
-				return false;
-			}
-		}
+#if SEVENSEGMENT_TRACE
+	_traceLevels = 0;
+	clearTrace();
+#endif
+
+	// Set clock and load pins to their idle levels
+	WRITE_PIN(TRACE_CLOCK, _pinClock, _device.clockIdleHigh ? HIGH : LOW);
+	if (_pinLoad != NO_PIN){
+		WRITE_PIN(TRACE_LOAD, _pinLoad, _device.latch == LATCH_ENABLE ? HIGH : LOW);
 	}
 
-#if SERIAL_MESSAGES_ON > 0
-	Serial.print("Could not find display driver!");
+	// Work out the shortest waits that meet the driver's timings on this board
+	calibrateTiming();
+
+	// Setup defaults
+	_wiring = LEFT_TO_RIGHT;
+	_maskReversed = false;
+#if SEVENSEGMENT_ORIENTATION
+	_orientation = ORIENTATION_NORMAL;
+	_segmentMap = segmentMap;
+#endif
+	_maskCursor = 0;
+	_alignment = LEFT;
+	_zeroPadding = false;
+#if SEVENSEGMENT_PRINT_CLASS
+	_streamOpen = false;
+#endif
+#if SEVENSEGMENT_BAR_GRAPH
+	_barCount = 0;
+#endif
+#if SEVENSEGMENT_FILTER
+	setFilter(0, 0);
+	setSmoothing(SMOOTH_NONE, 0);
 #endif
+#if SEVENSEGMENT_BLINK
+	_blinkRate = DEFAULT_BLINK_RATE;
+	_blinkTime = millis();
+	clearBlink();
+#endif
+	_editPage = 0;
+	_shownPage = 0;
+	_pageCount = 0;
+	_frameSequence = 0;
+	_frameWriters = 0;
+	_displayPending = false;
+	_sending = false;
+	memset(_data, 0, sizeof _data);
+	clear();
 
-	// Could not find the specified driver :(
-	return false;
+	return true;
 }
 
-
+#if SEVENSEGMENT_UNSIGNED
 /*
  * Print unsigned numbers
  */
@@ -194,6 +376,7 @@ void SevenSegment::printNumber(uint32_t v){
 
 	uint32_t r;
 	char buf[NUMBER_LENGTH + 2];
+	uint8_t length = _digitCount > NUMBER_LENGTH ? NUMBER_LENGTH : _digitCount;
 
 	// Ensure that array is clear!
 	memset(buf, 0, sizeof buf);
@@ -204,8 +387,8 @@ void SevenSegment::printNumber(uint32_t v){
 		return;
 	}
 
-	// Convert number to string
-	for (uint8_t x = NUMBER_LENGTH; x-- > 0; ){
+	// Convert number to string, one character per digit on the screen
+	for (uint8_t x = length; x-- > 0; ){
 		r = v % 10;
 		v /= 10;
 		buf[x] = '0' + r;
@@ -223,12 +406,19 @@ void SevenSegment::printNumber(uint32_t v){
 		}
 	}
 
+	// A 1 digit can't show a padding zero
+	else if (_maskHasOne && buf[0] == '0'){
+		buf[0] = ' ';
+	}
+
 	// Display
 	print(buf);
 }
+#endif
 
 
 
+#if SEVENSEGMENT_SIGNED
 /*
  * Print signed numbers
  */
@@ -251,6 +441,7 @@ void SevenSegment::printNumber(int32_t v){
 
 	uint8_t r = 0;
 	uint8_t c = 0;
+	uint8_t length = _digitCount > NUMBER_LENGTH ? NUMBER_LENGTH : _digitCount;
 
 	// Does number fit on screen?
 	if (v < _underflow || (v > 0 && (uint32_t) v >  _overflow)) {
@@ -258,16 +449,19 @@ void SevenSegment::printNumber(int32_t v){
 		return;
 	}
 
-	// Setup for negative display
+	// Setup for negative display, the minus takes the first digit unless the mask has its own
 	if (v < 0) {
 		buf[0] = '0';
 		c = 1;
 		v = -v;
 		negative = true;
+		if (_maskHasMinus){
+			length++;
+		}
 	}
 
 	// Put digits into char array
-	for (uint8_t x = NUMBER_LENGTH; x-- > c; ) {
+	for (uint8_t x = length; x-- > c; ) {
 		r = v % 10;
 		v /= 10;
 		buf[x] = '0' + r;
@@ -292,6 +486,11 @@ void SevenSegment::printNumber(int32_t v){
 		}
 	}
 
+	// A 1 digit can't show a padding zero, it comes after the minus if the mask has one
+	else if (_maskHasOne && (!negative || _maskHasMinus) && buf[c] == '0'){
+		buf[c] = ' ';
+	}
+
 	// Put minus back in
 	if (negative){
 		buf[0] = '-';
@@ -301,212 +500,1315 @@ void SevenSegment::printNumber(int32_t v){
 	print(buf);
 
 }
+#endif
 
+#if SEVENSEGMENT_FILTER
 /*
- * Trim spaces from start of a string
+ * Set how printFiltered() holds its value: the screen only changes when a
+ * reading differs from what is shown by more than deadband, and not within
+ * holdTime milliseconds of the last change
  */
-char* SevenSegment::trimZeroes(char* pString){
-	int nLen = strlen(pString);
-	size_t nPos = strspn(pString, "0");
-	if ( nPos > nLen || nPos == 0 )
-	return pString;
-	memmove( pString, pString + nPos, nLen - nPos);
-	pString[nLen-nPos] = 0;
-	return pString;
+void SevenSegment::setFilter(uint16_t deadband, uint16_t holdTime){
+	_filterDeadband = deadband;
+	_filterHold = holdTime;
+	_filterShown = false;
 }
 
-
 /*
- * Print string pointer
+ * Set how printFiltered() smooths readings: SMOOTH_AVERAGE over the last
+ * amount readings (up to 8), SMOOTH_EMA with each reading weighted 1/2^amount
+ * (amount up to 8, readings up to +/-8388607)
  */
-void SevenSegment::print(char* s){
+void SevenSegment::setSmoothing(smoothing_t smoothing, uint8_t amount){
 
-	if (_alignment == LEFT){
-		printAlignedLeft(s);
+	if (smoothing == SMOOTH_AVERAGE && amount > SMOOTHING_SAMPLES){
+		amount = SMOOTHING_SAMPLES;
 	}
-	else{
-		printAlignedRight(s);
+	else if (smoothing == SMOOTH_EMA && amount > SMOOTHING_SHIFT){
+		amount = SMOOTHING_SHIFT;
 	}
-}
 
+	_smoothing = smoothing;
+	_smoothingAmount = amount;
+	_smoothingCount = 0;
+	_smoothingIndex = 0;
+	_smoothingSum = 0;
+}
 
 /*
- * Print string pointer aligned to the left
+ * Print a reading from a noisy source, smoothed and held by the filter.  Only
+ * renders and sends the screen when the shown value has to change, returns
+ * true if it did
  */
-void SevenSegment::printAlignedLeft(char* s){
-	clearData();
-	_maskCursor = 0;
-	while (*s != 0 && _maskCursor < strlen(_mask)) {
-		printChar(*s, 1);
-		s++;
-	}
-	display();
+boolean SevenSegment::printFiltered(int32_t v){
+	return printFiltered(v, 0);
 }
 
 /*
- * Print string pointer aligned right
+ * As above for a fixed point reading, printFiltered(235, 1) shows 23.5.  The
+ * deadband is in the same units, 1 is 0.1 here
  */
-void SevenSegment::printAlignedRight(char* s){
+boolean SevenSegment::printFiltered(int32_t v, uint8_t decimals){
 
-	clearData();
-	_maskCursor = strlen(_mask) - 1;
-	for (char* p = s + strlen(s)-1; p >= s; p--){
-		printChar(*p, -1);
+	int32_t difference;
+
+	v = smooth(v);
+
+	if (_filterShown && _filterPage == _editPage && decimals == _filterDecimals){
+
+		difference = v - _filterValue;
+		if (difference < 0){
+			difference = -difference;
+		}
+
+		// Within the deadband or held, leave the screen alone
+		if (difference <= _filterDeadband || millis() - _filterTime < _filterHold){
+			return false;
+		}
 	}
-	display();
-}
 
-/*
- * Clear screen
- */
-void SevenSegment::clear(){
-	clearData();
-	display();
-}
+	if (decimals == 0){
+		printNumber(v);
+	}
+	else {
+		printFixed(v, decimals);
+	}
 
-/*
- * Turn all segments on
- */
-void SevenSegment::on(){
-	memset(_data, 1, sizeof _data);
-	display();
-}
+	_filterShown = true;
+	_filterPage = _editPage;
+	_filterValue = v;
+	_filterDecimals = decimals;
+	_filterTime = millis();
 
-/*
- * Clear all display data
- */
-void SevenSegment::clearData(){
-	memset(_data, 0, sizeof _data);
+	return true;
 }
 
 /*
- * Get status of single segment
+ * Smooth a reading as set by setSmoothing()
  */
-boolean SevenSegment::getSegment(uint8_t segment){
-	return _data[segment];
+int32_t SevenSegment::smooth(int32_t v){
+
+	switch (_smoothing){
+	case SMOOTH_AVERAGE:
+		if (_smoothingAmount < 2){
+			return v;
+		}
+
+		// Running sum over a ring of the last readings
+		if (_smoothingCount < _smoothingAmount){
+			_smoothingCount++;
+		}
+		else {
+			_smoothingSum -= _smoothingSamples[_smoothingIndex];
+		}
+		_smoothingSamples[_smoothingIndex] = v;
+		_smoothingSum += v;
+		_smoothingIndex = (_smoothingIndex + 1) % _smoothingAmount;
+
+		return _smoothingSum / _smoothingCount;
+
+	case SMOOTH_EMA:
+		if (_smoothingAmount == 0){
+			return v;
+		}
+
+		// Sum holds the average scaled up by 2^amount, the first reading starts it
+		if (_smoothingCount == 0){
+			_smoothingCount = 1;
+			_smoothingSum = v * (1L << _smoothingAmount);
+		}
+		else {
+			_smoothingSum += v - (_smoothingSum >> _smoothingAmount);
+		}
+
+		return (_smoothingSum + (1L << (_smoothingAmount - 1))) >> _smoothingAmount;
+
+	default:
+		return v;
+	}
 }
 
 /*
- * Set single segment
+ * Print a fixed point number with decimals digits after the point, zero
+ * padded like printNumber().  Shows an error if the mask has no point after
+ * the ones digit
  */
-void SevenSegment::setSegment(uint8_t segment, boolean value){
-	_data[segment] = value;
+void SevenSegment::printFixed(int32_t v, uint8_t decimals){
+
+	char buf[NUMBER_LENGTH + 3];
+	uint32_t u;
+	uint8_t i = sizeof buf - 1;
+	uint8_t digits = 0;
+	uint8_t minus = v < 0 && !_maskHasMinus ? 1 : 0;
+	uint8_t width = 0;
+	uint8_t ones;
+
+	// Does number fit on screen?
+	if (v < _underflow || (v > 0 && (uint32_t) v > _overflow)){
+		printError();
+		return;
+	}
+	u = v < 0 ? -v : v;
+
+	// Zero padding fills every digit the minus leaves
+	if (_alignment == RIGHT && _zeroPadding){
+		width = _digitCount - minus;
+	}
+
+	// Digits from the right, at least one before the point
+	buf[i] = 0;
+	do {
+		if (digits == decimals){
+			buf[--i] = '.';
+		}
+		buf[--i] = '0' + u % 10;
+		u /= 10;
+		digits++;
+	} while ((u != 0 || digits <= decimals || digits < width) && i > 1);
+
+	// The leading 0 can make it too long, the minus takes a digit unless the mask has its own
+	if (digits + minus > _digitCount){
+		printError();
+		return;
+	}
+
+	// Right aligned the ones digit is counted from the right, left aligned after the minus
+	ones = _alignment == RIGHT ? _digitCount - 1 - decimals : minus + digits - decimals - 1;
+	if (decimals > 0 && !hasPointAfterDigit(ones)){
+		printError();
+		return;
+	}
+
+	// A 1 digit can't show a padding zero
+	if (width && _maskHasOne && !minus && digits == _digitCount && buf[i] == '0'){
+		buf[i] = ' ';
+	}
+
+	if (v < 0){
+		buf[--i] = '-';
+	}
+
+	print(buf + i);
 }
 
 /*
- * Set the order the digits are arranged
+ * Is the position printed after a digit, counted from the left of the
+ * digits that aren't reserved, a point
  */
-void SevenSegment::setWiring(wiring_t wiring){
-	_wiring = wiring;
+boolean SevenSegment::hasPointAfterDigit(uint8_t digit){
+
+	uint8_t c;
+
+	for (c = 0; c < _maskLength; c++){
+		if ((_mask[c] == '8' || _mask[c] == '1') && !isReserved(c) && digit-- == 0){
+			break;
+		}
+	}
+
+	// Reserved positions are stepped over
+	while (++c < _maskLength && isReserved(c)){
+	}
+
+	return c < _maskLength && (_mask[c] == '.' || _mask[c] == '|');
 }
+#endif
 
+#if SEVENSEGMENT_COUNTER
 /*
- * Set the order the digits are arranged
+ * Set the counter and show it right aligned in the digits, blanking leading
+ * zeroes unless zero padding is on.  Punctuation is left alone.  Values that
+ * don't fit wrap around like an odometer
  */
-void SevenSegment::setAlignment(alignment_t alignment){
-	_alignment = alignment;
+void SevenSegment::setCounter(uint32_t v){
+
+	if (_digitCount == 0){
+		return;
+	}
+
+	// Wrap around
+	if (_overflow != MAXIMUM_UNSIGNED){
+		v %= _overflow + 1;
+	}
+
+	// Keep one decimal digit per digit position
+	_counterTop = 0;
+	for (uint8_t i = 0; i < _digitCount; i++){
+		_counter[i] = v % 10;
+		v /= 10;
+		if (_counter[i]){
+			_counterTop = i;
+		}
+	}
+
+	showCounter(_digitCount - 1);
 }
 
 /*
- * Set whether to pad numbers with 0s when printing right aligned
+ * Get the counter value
  */
-void SevenSegment::setZeroPadding(boolean padding){
-	_zeroPadding = padding;
+uint32_t SevenSegment::getCounter(){
+
+	uint32_t v = 0;
+
+	for (uint8_t i = _digitCount; i-- > 0; ){
+		v = v * 10 + _counter[i];
+	}
+	return v;
 }
 
 /*
- * Set cascaded - only supported on AY0438s which doubles segment count to 64
+ * Count up by one.  Only digits that carry are redrawn, the screen is not
+ * sent so call display() as often as you want it to change
  */
-void SevenSegment::setCascaded(boolean cascaded){
-	if (_device.cascadable){
-		_cascaded = cascaded;
+void SevenSegment::increment(){
+
+	uint8_t i = 0;
+
+	if (_digitCount == 0){
+		return;
+	}
+
+	// Carry until a digit doesn't roll over, a 1 position only goes to 1
+	while (++_counter[i] > (_mask[_digitPosition[i]] == '1' ? 1 : 9)){
+		_counter[i] = 0;
+		if (++i == _digitCount){
+			i--;
+			break;
+		}
+	}
+
+	if (i > _counterTop){
+		_counterTop = i;
 	}
+	showCounter(i);
 }
 
 /*
- * Get the segments defined for a character as a byte
+ * Count down by one, wrapping from zero to the largest value shown
  */
-uint8_t SevenSegment::getSegmentByte(uint8_t character){
+void SevenSegment::decrement(){
 
-	// Out of range so display a blank
-	if (character < FIRST_CHARACTER || character > LAST_CHARACTER){
-		return 0;
+	uint8_t i = 0;
+
+	if (_digitCount == 0){
+		return;
 	}
-	else {
-		// read character from progmem
-		return pgm_read_byte(&segmentMap[character - FIRST_CHARACTER]);
+
+	// Borrow until a digit doesn't roll under
+	while (_counter[i]-- == 0){
+		_counter[i] = _mask[_digitPosition[i]] == '1' ? 1 : 9;
+		if (++i == _digitCount){
+			i--;
+			break;
+		}
 	}
+
+	showCounter(i > _counterTop ? i : _counterTop);
 }
 
 /*
- * Calculate the maximum and minimum values that can be displayed
+ * Add to the counter, which can be negative.  Works digit by digit so
+ * only digits up to the last carry are redrawn
  */
-boolean SevenSegment::calculateDisplayRange(){
-
-	uint8_t fullDigits = 0;
-	boolean foundDigit = false;
-	boolean foundMinus = false;
-	boolean foundOne = false;
+void SevenSegment::add(int32_t n){
 
-	// Clear previous values just in case
-	_overflow = 0;
-	_underflow = 0;
+	boolean subtract = n < 0;
+	uint32_t v = subtract ? 0UL - (uint32_t) n : n;
+	uint8_t carry = 0;
+	uint8_t last = 0;
+	int8_t digit;
+	uint8_t radix;
 
-	// Examine each character in the screen configuration
-	for (uint8_t c = 0; c < strlen(_mask); c++){
+	if (_digitCount == 0){
+		return;
+	}
 
-		switch (_mask[c]){
+	for (uint8_t i = 0; i < _digitCount && (v || carry); i++){
 
-		// A minus character should appear once and before anything else
-		case '-':
-			if (!foundMinus && !foundOne && !foundDigit)
-				foundMinus = true;
-			else
-				return false;
-			break;
+		radix = _mask[_digitPosition[i]] == '1' ? 2 : 10;
 
-		// A single 1 digit should only appear once before a digit
-		case '1':
-			if (!foundOne && !foundDigit){
-				foundOne = true;
-				_overflow = 1;
+		if (subtract){
+			digit = _counter[i] - (v % 10) - carry;
+			for (carry = 0; digit < 0; carry++){
+				digit += radix;
 			}
-			else
-				return false;
-			break;
+		}
+		else {
+			digit = _counter[i] + (v % 10) + carry;
+			for (carry = 0; digit >= radix; carry++){
+				digit -= radix;
+			}
+		}
 
-		// 8 any digit can be displayed at this position
-		case '8':
+		_counter[i] = digit;
+		v /= 10;
+		last = i;
+	}
+
+	showCounter(last > _counterTop ? last : _counterTop);
+}
+
+/*
+ * Redraw counter digits 0 to last, working out the leading digit first
+ */
+void SevenSegment::showCounter(uint8_t last){
+
+	uint8_t c;
+	uint8_t position;
+
+	// Find the leading digit, anything that changed is at or below last
+	if (last > _counterTop){
+		_counterTop = last;
+	}
+	while (_counterTop > 0 && _counter[_counterTop] == 0){
+		_counterTop--;
+	}
+
+	// Written by position rather than through the print cursor, so counting
+	// from an interrupt can't upset a print() in the main loop
+	beginFrameWrite();
+	for (uint8_t i = 0; i <= last; i++){
+		position = _digitPosition[i];
+
+		// Leading zeroes are blank, a 1 position can only show a 1
+		if ((i > _counterTop && !_zeroPadding) || (_counter[i] == 0 && _mask[position] == '1')){
+			c = ' ';
+		}
+		else {
+			c = '0' + _counter[i];
+		}
+		filterChanged(position);
+		writeBits(getMaskIndex(position), getMaskCharBits(_mask[position], c), getMaskCharBitCount(_mask[position]));
+	}
+	endFrameWrite();
+}
+#endif
+
+#if SEVENSEGMENT_BAR_GRAPH
+/*
+ * Use a list of segments, made with BAR_SEGMENT(), as a bar graph lit from
+ * the first entry.  The list is read as the level changes so it must stay in
+ * scope; set the wiring and orientation first.  Returns false if an entry is
+ * not on the screen
+ */
+boolean SevenSegment::setBarGraph(const uint8_t* segments, uint8_t count){
+
+	uint8_t position;
+
+	_barCount = 0;
+
+	// Check everything once so updates don't have to
+	for (uint8_t i = 0; i < count; i++){
+		position = segments[i] >> 3;
+
+		if (position >= _maskLength || (segments[i] & 7) >= getMaskCharBitCount(_mask[position])){
+			return false;
+		}
+	}
+
+	// Start with the bar empty
+	_bar = segments;
+	_barCount = count;
+	_barLevel = count;
+	setBarLevel(0);
+
+	return true;
+}
+
+/*
+ * Light the first level segments of the bar graph.  Only segments between the
+ * old and new level change and the screen is not sent, call display()
+ */
+void SevenSegment::setBarLevel(uint8_t level){
+
+	if (level > _barCount){
+		level = _barCount;
+	}
+
+	beginFrameWrite();
+	for ( ; _barLevel < level; _barLevel++){
+		setSegment(getBarIndex(_bar[_barLevel]), true);
+	}
+	for ( ; _barLevel > level; _barLevel--){
+		setSegment(getBarIndex(_bar[_barLevel - 1]), false);
+	}
+	endFrameWrite();
+}
+
+/*
+ * Screen data position of a bar graph entry
+ */
+uint8_t SevenSegment::getBarIndex(uint8_t entry){
+
+	uint8_t position = entry >> 3;
+	uint8_t segment = entry & 7;
+
+#if SEVENSEGMENT_ORIENTATION
+	if (_mask[position] == '8'){
+		segment = getOrientedSegment(segment);
+	}
+#endif
+	return getMaskIndex(position) + segment;
+}
+
+/*
+ * Show value out of maximum on the bar graph, e.g. an analogRead() out of 1023
+ */
+void SevenSegment::setBarValue(uint16_t value, uint16_t maximum){
+	if (maximum){
+		setBarLevel((uint32_t) value * _barCount / maximum);
+	}
+}
+#endif
+
+/*
+ * Trim spaces from start of a string
+ */
+char* SevenSegment::trimZeroes(char* pString){
+	int nLen = strlen(pString);
+	size_t nPos = strspn(pString, "0");
+	if ( nPos > nLen || nPos == 0 )
+	return pString;
+	memmove( pString, pString + nPos, nLen - nPos);
+	pString[nLen-nPos] = 0;
+	return pString;
+}
+
+
+/*
+ * Print string pointer
+ */
+void SevenSegment::print(const char* s){
+
+	if (_alignment == LEFT){
+		printAlignedLeft(s);
+	}
+	else{
+		printAlignedRight(s);
+	}
+}
+
+#if ARDUINO >= 100
+/*
+ * Print string stored in flash with F(), read straight from flash
+ */
+void SevenSegment::print(const __FlashStringHelper* s){
+
+	if (_alignment == LEFT){
+		printLeft((const char*) s, true);
+	}
+	else{
+		printRight((const char*) s, true);
+	}
+}
+#endif
+
+/*
+ * Print string pointer aligned to the left
+ */
+void SevenSegment::printAlignedLeft(const char* s){
+	printLeft(s, false);
+}
+
+/*
+ * Print string pointer aligned right
+ */
+void SevenSegment::printAlignedRight(const char* s){
+	printRight(s, false);
+}
+
+/*
+ * Print a string in RAM or flash from the left of the screen
+ */
+void SevenSegment::printLeft(const char* s, boolean flash){
+
+	uint8_t c;
+
+#if SEVENSEGMENT_PRINT_CLASS
+	// Anything being streamed is replaced
+	_streamOpen = false;
+#endif
+
+	beginFrameWrite();
+	filterChanged(-1);
+	clearData();
+	_maskCursor = 0;
+	while ((c = readChar(s, flash)) != 0 && _maskCursor < _maskLength) {
+		printChar(c, 1);
+		s++;
+	}
+	endFrameWrite();
+	displayIfShown();
+}
+
+/*
+ * Print a string in RAM or flash from the right of the screen, walking it backwards
+ */
+void SevenSegment::printRight(const char* s, boolean flash){
+
+#if SEVENSEGMENT_PRINT_CLASS
+	// Anything being streamed is replaced
+	_streamOpen = false;
+#endif
+
+	beginFrameWrite();
+	filterChanged(-1);
+	clearData();
+	_maskCursor = _maskLength - 1;
+	for (const char* p = s + (flash ? strlen_P(s) : strlen(s)); p-- > s && _maskCursor >= 0; ){
+		printChar(readChar(p, flash), -1);
+	}
+	endFrameWrite();
+	displayIfShown();
+}
+
+/*
+ * Read a character from RAM or flash
+ */
+uint8_t SevenSegment::readChar(const char* p, boolean flash){
+	return flash ? pgm_read_byte(p) : *p;
+}
+
+#if SEVENSEGMENT_PRINT_CLASS
+/*
+ * Print interface, characters are added to the screen as they arrive.  A new
+ * line sends them to the screen and the next character starts afresh
+ */
+#if ARDUINO >= 100
+size_t SevenSegment::write(uint8_t c){
+	streamChar(c);
+	return 1;
+}
+#else
+void SevenSegment::write(uint8_t c){
+	streamChar(c);
+}
+#endif
+
+/*
+ * Send anything streamed to the screen
+ */
+void SevenSegment::flush(){
+	commit();
+}
+
+/*
+ * Add a streamed character.  Left aligned text goes straight into the screen
+ * data, right aligned text needs its end before it can be placed so the
+ * characters that could still be seen are kept until commit()
+ */
+void SevenSegment::streamChar(uint8_t c){
+
+	if (c == '\r'){
+		return;
+	}
+	if (c == '\n'){
+		commit();
+		return;
+	}
+
+	beginFrameWrite();
+	filterChanged(-1);
+
+	// First character of a new line
+	if (!_streamOpen){
+		_streamOpen = true;
+		_streamLength = 0;
+		clearData();
+		_maskCursor = 0;
+	}
+
+	if (_alignment == LEFT){
+		if (_maskCursor < _maskLength){
+			printChar(c, 1);
+		}
+	}
+	else {
+
+		// Oldest character drops off the left when full
+		if (_streamLength == sizeof _stream - 1){
+			memmove(_stream, _stream + 1, --_streamLength);
+		}
+		_stream[_streamLength++] = c;
+	}
+	endFrameWrite();
+}
+
+/*
+ * Finish a streamed line and send it to the screen
+ */
+void SevenSegment::commit(){
+
+	if (!_streamOpen){
+		return;
+	}
+
+	if (_alignment == LEFT){
+		_streamOpen = false;
+		displayIfShown();
+	}
+	else {
+		_stream[_streamLength] = 0;
+		printRight(_stream, false);
+	}
+}
+#endif
+
+/*
+ * Clear screen
+ */
+void SevenSegment::clear(){
+	beginFrameWrite();
+	filterChanged(-1);
+	clearData();
+	endFrameWrite();
+	displayIfShown();
+}
+
+/*
+ * Turn all segments on
+ */
+void SevenSegment::on(){
+	beginFrameWrite();
+	filterChanged(-1);
+	memset(_data[_editPage], 0xFF, sizeof _data[_editPage]);
+	endFrameWrite();
+	displayIfShown();
+}
+
+/*
+ * Only send data to the screen if the page being changed is the one showing
+ */
+void SevenSegment::displayIfShown(){
+	if (_editPage == _shownPage){
+		display();
+	}
+}
+
+/*
+ * Start changing screen data.  Until the matching endFrameWrite() display()
+ * leaves the data alone and the change is sent when it ends.  Can be nested
+ * and used from an interrupt
+ */
+void SevenSegment::beginFrameWrite(){
+	SEVENSEGMENT_ATOMIC {
+		_frameWriters++;
+	}
+}
+
+/*
+ * Finish changing screen data, sending it if display() was wanted meanwhile
+ */
+void SevenSegment::endFrameWrite(){
+
+	boolean send = false;
+
+	SEVENSEGMENT_ATOMIC {
+		_frameSequence++;
+		send = --_frameWriters == 0 && _displayPending;
+	}
+
+	if (send){
+		display();
+	}
+}
+
+/*
+ * Clear display data, apart from reserved positions
+ */
+void SevenSegment::clearData(){
+
+#if SEVENSEGMENT_BAR_GRAPH
+	// The bar goes with everything else, so it starts again from empty
+	_barLevel = 0;
+#endif
+	if (_reserved == 0){
+		memset(_data[_editPage], 0, sizeof _data[_editPage]);
+		return;
+	}
+
+	// Position by position so bits shared with a reserved one are kept
+	for (uint8_t i = 0; i < _maskLength; i++){
+		if (!isReserved(i)){
+			writeBits(getMaskIndex(i), 0, getMaskCharBitCount(_mask[i]));
+		}
+	}
+}
+
+/*
+ * Get status of single segment
+ */
+boolean SevenSegment::getSegment(uint8_t segment){
+	return _data[_editPage][segment >> 3] & (1 << (segment & 7)) ? true : false;
+}
+
+/*
+ * Set single segment
+ */
+void SevenSegment::setSegment(uint8_t segment, boolean value){
+	beginFrameWrite();
+#if SEVENSEGMENT_FILTER
+	filterChanged(_reserved ? getSegmentPosition(segment) : -1);
+#endif
+	writeBits(segment, value ? 1 : 0, 1);
+	endFrameWrite();
+}
+
+/*
+ * Show a character at a mask position, leaving the rest of the screen as it
+ * is.  Doesn't move the print position so it can be used from an interrupt
+ * while the main loop prints elsewhere.  Does not send the screen
+ */
+void SevenSegment::setCharacter(uint8_t position, char c){
+
+	if (position >= _maskLength){
+		return;
+	}
+
+	beginFrameWrite();
+	filterChanged(position);
+	writeBits(getMaskIndex(position), getMaskCharBits(_mask[position], c), getMaskCharBitCount(_mask[position]));
+	endFrameWrite();
+}
+
+/*
+ * Reserve a mask position for setCharacter() or setSegment(), e.g. from an
+ * interrupt.  print(), printError() and clear() leave it as it is and
+ * printing carries on in the next position.  Numbers and the counter only
+ * use the digits left, so the counter starts again from 0.  Set the
+ * orientation first
+ */
+void SevenSegment::setReserved(uint8_t position, boolean reserved){
+
+	if (position >= _maskLength){
+		return;
+	}
+
+	if (reserved){
+		_reserved |= 1UL << position;
+	}
+	else {
+		_reserved &= ~(1UL << position);
+	}
+
+	calculateNumberRange();
+#if SEVENSEGMENT_COUNTER
+	memset(_counter, 0, sizeof _counter);
+	_counterTop = 0;
+#endif
+}
+
+/*
+ * Note a change at a mask position, or the whole page for -1.  If it is over
+ * what printFiltered() showed the next reading is drawn again.  Reserved
+ * positions and other pages are not drawn by it so don't count
+ */
+void SevenSegment::filterChanged(int8_t position){
+
+#if SEVENSEGMENT_FILTER
+	if (_editPage == _filterPage && (position < 0 || !isReserved(position))){
+		_filterShown = false;
+	}
+#endif
+}
+
+/*
+ * Is a mask position reserved
+ */
+boolean SevenSegment::isReserved(uint8_t position){
+	return _reserved & (1UL << position) ? true : false;
+}
+
+#if SEVENSEGMENT_BLINK
+/*
+ * Make the segments at a mask position blink, set the wiring before using this
+ */
+void SevenSegment::setBlink(uint8_t position, boolean blink){
+
+	if (position >= _maskLength){
+		return;
+	}
+
+	uint8_t index = getMaskIndex(position);
+	uint8_t bitCount = getMaskCharBitCount(_mask[position]);
+
+	for (uint8_t i = index; i < index + bitCount; i++){
+		if (blink){
+			_blink[i >> 3] |= 1 << (i & 7);
+		}
+		else {
+			_blink[i >> 3] &= ~(1 << (i & 7));
+		}
+	}
+}
+
+/*
+ * Set how many milliseconds blinking segments stay on, then off
+ */
+void SevenSegment::setBlinkRate(uint16_t rate){
+	_blinkRate = rate;
+}
+
+/*
+ * Stop all segments blinking
+ */
+void SevenSegment::clearBlink(){
+	memset(_blink, 0, sizeof _blink);
+	_blinkOff = false;
+}
+#endif
+
+/*
+ * Call often (from loop() or a timer), flips the blink phase and resends the
+ * current data when the blink rate has elapsed.  Returns true if it did
+ */
+boolean SevenSegment::update(){
+
+	boolean changed = false;
+
+	// Time to rotate to the next page?
+	if (_pageCount > 1 && millis() - _pageTime >= _pageInterval){
+		_pageTime = millis();
+		_shownPage = (_shownPage + 1) % _pageCount;
+		changed = true;
+	}
+
+#if SEVENSEGMENT_BLINK
+	// Anything to blink?
+	uint8_t blinking = 0;
+	for (uint8_t i = 0; i < FRAME_BYTES; i++){
+		blinking |= _blink[i];
+	}
+
+	if (blinking && millis() - _blinkTime >= _blinkRate){
+		_blinkTime = millis();
+		_blinkOff = !_blinkOff;
+		changed = true;
+	}
+#endif
+
+	// One transfer covers both
+	if (changed){
+		display();
+	}
+
+	return changed;
+}
+
+/*
+ * Choose which page printing and setting segments changes
+ */
+void SevenSegment::setPage(uint8_t page){
+	if (page < SEVENSEGMENT_PAGES){
+		_editPage = page;
+	}
+}
+
+/*
+ * Send a page to the screen, it is already rendered so this is a single transfer
+ */
+void SevenSegment::showPage(uint8_t page){
+	if (page < SEVENSEGMENT_PAGES){
+		_shownPage = page;
+		display();
+	}
+}
+
+/*
+ * Get the page on the screen
+ */
+uint8_t SevenSegment::getPage(){
+	return _shownPage;
+}
+
+/*
+ * Have update() show pages 0 to count - 1 in turn, interval milliseconds each.
+ * A count of 0 or 1 stops rotating
+ */
+void SevenSegment::setPageRotation(uint8_t count, uint16_t interval){
+	_pageCount = count > SEVENSEGMENT_PAGES ? SEVENSEGMENT_PAGES : count;
+	_pageInterval = interval;
+	_pageTime = millis();
+}
+
+/*
+ * Get why begin() failed
+ */
+setup_error_t SevenSegment::getSetupError(){
+	return _setupError;
+}
+
+/*
+ * Get the mask position that made begin() fail, -1 if not caused by the mask
+ */
+int8_t SevenSegment::getSetupErrorPosition(){
+	return _setupErrorPosition;
+}
+
+/*
+ * Get the largest number that can be displayed
+ */
+uint32_t SevenSegment::getMaximum(){
+	return _overflow;
+}
+
+/*
+ * Get the smallest number that can be displayed
+ */
+int32_t SevenSegment::getMinimum(){
+	return _underflow;
+}
+
+/*
+ * Get the number of digit positions (8 and 1) in the mask
+ */
+uint8_t SevenSegment::getDigitCount(){
+	return _digitCount;
+}
+
+/*
+ * Set the order the digits are arranged
+ */
+void SevenSegment::setWiring(wiring_t wiring){
+
+	// A turned round mask is already walked the other way
+	if (wiring != _wiring){
+		_maskReversed = !_maskReversed;
+	}
+	_wiring = wiring;
+}
+
+/*
+ * Set the order the digits are arranged
+ */
+void SevenSegment::setAlignment(alignment_t alignment){
+	_alignment = alignment;
+}
+
+/*
+ * Set whether to pad numbers with 0s when printing right aligned
+ */
+void SevenSegment::setZeroPadding(boolean padding){
+	_zeroPadding = padding;
+}
+
+#if SEVENSEGMENT_ORIENTATION
+/*
+ * Set which way up the screen is seen, before printing.  Rotating or
+ * mirroring reverses the digit order so points move to the other side of
+ * their digit.  Returns false if the mask has a minus or 1 position, as
+ * they would end up on the right
+ */
+boolean SevenSegment::setOrientation(orientation_t orientation){
+
+	boolean reversing = (orientation == ORIENTATION_ROTATED || orientation == ORIENTATION_MIRRORED) !=
+		(_orientation == ORIENTATION_ROTATED || _orientation == ORIENTATION_MIRRORED);
+
+	if (orientation > ORIENTATION_FLIPPED || (reversing && (_maskHasMinus || _maskHasOne))){
+		return false;
+	}
+
+	if (reversing){
+		reverseMask();
+		_maskReversed = !_maskReversed;
+	}
+
+	// Characters are read from the map already turned this way
+	_orientation = orientation;
+	_segmentMap = (const unsigned char*) pgm_read_ptr(&segmentMaps[orientation]);
+
+	return true;
+}
+
+/*
+ * Turn the mask round, the data positions don't move
+ */
+void SevenSegment::reverseMask(){
+
+	char c;
+	uint8_t offset = 0;
+
+	for (uint8_t i = 0; i < _maskLength / 2; i++){
+		c = _mask[i];
+		_mask[i] = _mask[_maskLength - 1 - i];
+		_mask[_maskLength - 1 - i] = c;
+	}
+
+	for (uint8_t i = 0; i < _maskLength; i++){
+		_maskOffset[i] = offset;
+		offset += getMaskCharBitCount(_mask[i]);
+	}
+
+	findDigitPositions();
+}
+
+/*
+ * Which segment of a digit is seen as the given one in this orientation
+ */
+uint8_t SevenSegment::getOrientedSegment(uint8_t segment){
+
+	uint8_t bits = 1 << segment;
+
+	switch (_orientation){
+	case ORIENTATION_ROTATED:
+		bits = SEGMENTS_ROTATED(bits);
+		break;
+	case ORIENTATION_MIRRORED:
+		bits = SEGMENTS_MIRRORED(bits);
+		break;
+	case ORIENTATION_FLIPPED:
+		bits = SEGMENTS_FLIPPED(bits);
+		break;
+	default:
+		break;
+	}
+
+	for (segment = 0; bits > 1; segment++){
+		bits >>= 1;
+	}
+	return segment;
+}
+#endif
+
+/*
+ * Set cascaded - only supported on AY0438s which doubles segment count to 64
+ */
+void SevenSegment::setCascaded(boolean cascaded){
+
+	// Can't go back to a single driver if the mask needs both
+	if (_device.cascadable && (cascaded || _maskBits <= _device.segments)){
+		_cascaded = cascaded;
+	}
+}
+
+/*
+ * Get the segments defined for a character as a byte
+ */
+uint8_t SevenSegment::getSegmentByte(uint8_t character){
+
+	// Out of range so display a blank
+	if (character < FIRST_CHARACTER || character > LAST_CHARACTER){
+		return 0;
+	}
+	else {
+		// read character from progmem, turned to the orientation
+#if SEVENSEGMENT_ORIENTATION
+		return pgm_read_byte(&_segmentMap[character - FIRST_CHARACTER]);
+#else
+		return pgm_read_byte(&segmentMap[character - FIRST_CHARACTER]);
+#endif
+	}
+}
+
+/*
+ * Validate the screen mask against the driver and calculate the maximum and
+ * minimum values that can be displayed.  Per position data array offsets are
+ * worked out here once so printing never has to walk the mask
+ */
+boolean SevenSegment::calculateDisplayRange(const char* screenMask){
+
+	uint8_t bitCount = 0;
+	uint8_t maxBits = _device.segments;
+	boolean foundDigit = false;
+#if SEVENSEGMENT_MASK_CHECKS
+	boolean foundMinus = false;
+#endif
+	boolean foundOne = false;
+	uint8_t c;
+
+	// Clear previous values just in case
+	_overflow = 0;
+	_underflow = 0;
+	_reserved = 0;
+	_maskLength = 0;
+	_maskBits = 0;
+	_digitCount = 0;
+	_maskHasMinus = false;
+	_maskHasOne = false;
+	_mask[0] = 0;
+
+	// Cascadable drivers can be doubled up
+	if (_device.cascadable){
+		maxBits *= 2;
+	}
+
+	// Can't have more than the screen data holds whatever the driver
+	if (maxBits > FRAME_SEGMENTS){
+		maxBits = FRAME_SEGMENTS;
+	}
+
+	// Examine each character in the screen configuration
+	for (c = 0; screenMask[c] != 0; c++){
+
+		// Leave room for the terminator
+		if (c >= MASK_COUNT - 1)
+			return setupFailed(SETUP_MASK_TOO_LONG, c);
+
+		switch (screenMask[c]){
+
+		// A minus character should appear once and before anything else
+		case '-':
+#if SEVENSEGMENT_MASK_CHECKS
+			if (foundMinus || foundOne || foundDigit)
+				return setupFailed(SETUP_MISPLACED_MINUS, c);
+			foundMinus = true;
+#endif
+			break;
+
+		// A single 1 digit should only appear once before a digit.  Always
+		// checked as it keeps the digit count within the counter's arrays
+		case '1':
+			if (foundOne || foundDigit)
+				return setupFailed(SETUP_MISPLACED_ONE, c);
+			foundOne = true;
+			break;
+
+		// 8 any digit can be displayed at this position
+		case '8':
 			foundDigit = true;
-			fullDigits++;
-			_overflow *= 10;
-			_overflow += 9;
-			if (fullDigits > 1){
-				_underflow *= 10;
-				_underflow -= 9;
-			}
 			break;
 
-		// Decimal points, colons and pipes can not appear more than once consecutively
-		case '.':
-		case '|':
-		case ':':
-			if (c > 0 && (_mask[c-1] == '.' || _mask[c-1] == '|' || _mask[c-1] == ':'))
-				return false;
+		// Decimal points, colons and pipes can not appear more than once consecutively
+		case '.':
+		case '|':
+		case ':':
+#if SEVENSEGMENT_MASK_CHECKS
+			if (c > 0 && (screenMask[c-1] == '.' || screenMask[c-1] == '|' || screenMask[c-1] == ':'))
+				return setupFailed(SETUP_REPEATED_PUNCTUATION, c);
+#endif
+			break;
+
+		// Invalid character in mask :(
+		default:
+#if SEVENSEGMENT_MASK_CHECKS
+			return setupFailed(SETUP_INVALID_CHARACTER, c);
+#else
+			break;
+#endif
+		}
+
+		// Remember where this position starts in the data array
+		_maskOffset[c] = bitCount;
+		bitCount += getMaskCharBitCount(screenMask[c]);
+
+		// Does the mask still fit on the driver?
+		if (bitCount > maxBits)
+			return setupFailed(SETUP_TOO_MANY_SEGMENTS, c);
+
+		_mask[c] = screenMask[c];
+	}
+
+	// Nothing to display on
+	if (c == 0)
+		return setupFailed(SETUP_MASK_EMPTY, 0);
+
+	_mask[c] = 0;
+	_maskLength = c;
+	_maskBits = bitCount;
+
+	calculateNumberRange();
+
+	// Needs a second driver if the mask doesn't fit on one
+	_cascaded = _maskBits > _device.segments;
+
+	// All OK
+	_setupError = SETUP_OK;
+	_setupErrorPosition = -1;
+	return true;
+}
+
+/*
+ * Work out the largest and smallest numbers that fit in the positions that
+ * aren't reserved
+ */
+void SevenSegment::calculateNumberRange(){
+
+	uint8_t fullDigits = 0;
+	boolean foundMinus = false;
+	boolean foundOne = false;
+
+	_overflow = 0;
+	_underflow = 0;
+
+	for (uint8_t c = 0; c < _maskLength; c++){
+
+		if (isReserved(c)){
+			continue;
+		}
+
+		switch (_mask[c]){
+		case '-':
+			foundMinus = true;
+			break;
+
+		case '1':
+			foundOne = true;
+			_overflow = 1;
 			break;
 
-		// Invalid character in mask :(
-		default:
-			return false;
+		// Limits stop at what 32 bits can hold
+		case '8':
+			fullDigits++;
+			if (_overflow > (MAXIMUM_UNSIGNED - 9) / 10){
+				_overflow = MAXIMUM_UNSIGNED;
+			}
+			else {
+				_overflow *= 10;
+				_overflow += 9;
+			}
+			if (fullDigits > 1){
+				if (_underflow < (9 - MAXIMUM_SIGNED) / 10){
+					_underflow = -MAXIMUM_SIGNED;
+				}
+				else {
+					_underflow *= 10;
+					_underflow -= 9;
+				}
+			}
+			break;
 		}
 	}
 
+	_digitCount = fullDigits + (foundOne ? 1 : 0);
+	_maskHasMinus = foundMinus;
+	_maskHasOne = foundOne;
+
 	// If mask starts with a minus then underflow is always overflow * -1
 	if (foundMinus)
-		_underflow = _overflow * -1;
+		_underflow = _overflow > MAXIMUM_SIGNED ? -MAXIMUM_SIGNED : _overflow * -1;
 
-	// All OK
-	return true;
+	findDigitPositions();
+}
+
+/*
+ * Work out the digit positions for the counter, least significant first
+ */
+void SevenSegment::findDigitPositions(){
+
+#if SEVENSEGMENT_COUNTER
+	uint8_t digit = 0;
+
+	for (uint8_t c = _maskLength; c-- > 0; ){
+		if ((_mask[c] == '8' || _mask[c] == '1') && !isReserved(c)){
+			_digitPosition[digit++] = c;
+		}
+	}
+#endif
+}
+
+/*
+ * Record why the mask was rejected and where
+ */
+boolean SevenSegment::setupFailed(setup_error_t error, int8_t position){
+
+	_setupError = error;
+	_setupErrorPosition = position;
+	_mask[0] = 0;
+	_maskLength = 0;
+	_overflow = 0;
+	_underflow = 0;
+
+	return false;
 }
 
 // ---------------------------------------------
@@ -514,26 +1816,207 @@ boolean SevenSegment::calculateDisplayRange(){
 // ---------------------------------------------
 
 /*
- * Pulse clock
+ * Time how long digitalWrite() and one turn of the delay loop take on this
+ * board, then work out how many turns each of the driver's timings needs on
+ * top of the digitalWrite() that comes before it.  Called by begin(), call
+ * again if the CPU clock is changed
+ */
+void SevenSegment::calibrateTiming(){
+
+	uint8_t idle = _device.clockIdleHigh ? HIGH : LOW;
+	uint16_t count = 1;
+	uint32_t start;
+	uint32_t elapsed;
+	uint32_t quickest = 0xFFFFFFFF;
+
+	// Time some writes that leave the clock where it is.  micros() can tick
+	// just after start, so a step is taken off to never overestimate them
+	for (uint8_t sample = 0; sample < CALIBRATION_SAMPLES; sample++){
+		start = micros();
+		for (uint8_t i = 0; i < CALIBRATION_WRITES; i++){
+			WRITE_PIN(TRACE_CLOCK, _pinClock, idle);
+		}
+		elapsed = micros() - start;
+		if (elapsed < quickest){
+			quickest = elapsed;
+		}
+	}
+	quickest = quickest > MICROS_STEP ? quickest - MICROS_STEP : 0;
+	_writeTime = quickest * 1000 / CALIBRATION_WRITES;
+
+	// Run the delay loop for long enough to be measured with micros()
+	do {
+		count *= 2;
+		start = micros();
+		spinWait(count);
+		elapsed = micros() - start;
+	} while (elapsed < CALIBRATION_TIME && count < 0x8000);
+
+	// Time it again at that length, also taking the quickest less a step
+	quickest = elapsed;
+	for (uint8_t sample = 1; sample < CALIBRATION_SAMPLES; sample++){
+		start = micros();
+		spinWait(count);
+		elapsed = micros() - start;
+		if (elapsed < quickest){
+			quickest = elapsed;
+		}
+	}
+	quickest = quickest > MICROS_STEP ? quickest - MICROS_STEP : 0;
+
+	_spinTime = quickest * 1000 / count;
+	if (_spinTime == 0){
+		_spinTime = 1;
+	}
+
+	_clockSpins = getSpins(_device.clockWidth);
+	_setupSpins = getSpins(_device.setupTime);
+	_holdSpins = getSpins(_device.holdTime);
+	_loadSpins = getSpins(_device.loadWidth);
+
+#if SERIAL_MESSAGES_ON > 0
+	Serial.print("digitalWrite ns: ");
+	Serial.println(_writeTime);
+	Serial.print("Delay loop ns: ");
+	Serial.println(_spinTime);
+#endif
+}
+
+/*
+ * Number of delay loop turns needed to wait the specified nanoseconds after
+ * a digitalWrite(), rounded up.  None on boards where digitalWrite() is slow
+ * enough.  Both times are underestimates so the wait is never short
+ */
+uint16_t SevenSegment::getSpins(uint16_t ns){
+
+	if (ns <= _writeTime){
+		return 0;
+	}
+	return (ns - _writeTime + _spinTime - 1) / _spinTime;
+}
+
+/*
+ * Delay loop, volatile so the compiler keeps it
+ */
+void SevenSegment::spinWait(uint16_t count){
+	for (volatile uint16_t i = count; i > 0; i--);
+}
+
+/*
+ * Pulse clock away from its idle level and back
  */
 void SevenSegment::pulseClock(){
-	digitalWrite(_pinClock, HIGH);
-	digitalWrite(_pinClock, LOW);
+	WRITE_PIN(TRACE_CLOCK, _pinClock, _device.clockIdleHigh ? LOW : HIGH);
+	if (_clockSpins){
+		spinWait(_clockSpins);
+	}
+	WRITE_PIN(TRACE_CLOCK, _pinClock, _device.clockIdleHigh ? HIGH : LOW);
+	if (_clockSpins){
+		spinWait(_clockSpins);
+	}
 }
 
 /*
  * Pulse load
  */
 void SevenSegment::pulseLoad(){
-	digitalWrite(_pinLoad, HIGH);
-	digitalWrite(_pinLoad, LOW);
+	WRITE_PIN(TRACE_LOAD, _pinLoad, HIGH);
+	if (_loadSpins){
+		spinWait(_loadSpins);
+	}
+	WRITE_PIN(TRACE_LOAD, _pinLoad, LOW);
+}
+
+/*
+ * Clock a single bit into the driver, only waiting where the board is too
+ * fast for the driver
+ */
+void SevenSegment::shiftBit(boolean value){
+	WRITE_PIN(TRACE_DATA, _pinData, value ? HIGH : LOW);
+	if (_setupSpins){
+		spinWait(_setupSpins);
+	}
+	pulseClock();
+	if (_holdSpins){
+		spinWait(_holdSpins);
+	}
+}
+
+/*
+ * Copy the page being shown as it should be sent, blinking segments are dark
+ * during the off phase.  The sequence number changes with every finished
+ * write so a copy that raced one is taken again.  Returns false if a write
+ * is under way, it will send the screen when it finishes
+ */
+boolean SevenSegment::copyFrame(uint8_t* frame){
+
+	uint8_t sequence;
+
+	do {
+		sequence = _frameSequence;
+		if (_frameWriters){
+			return false;
+		}
+		for (uint8_t i = 0; i < FRAME_BYTES; i++){
+			frame[i] = _data[_shownPage][i];
+#if SEVENSEGMENT_BLINK
+			if (_blinkOff){
+				frame[i] &= ~_blink[i];
+			}
+#endif
+		}
+	} while (sequence != _frameSequence || _frameWriters);
+
+	return true;
 }
 
 /*
- * Outputs data to screen :)
+ * Outputs data to screen :)  Safe to call from an interrupt: if the screen is
+ * being sent or changed already the latest data is sent once that finishes
  */
 void SevenSegment::display(){
 
+	uint8_t frame[FRAME_BYTES];
+	boolean busy = false;
+
+	// Only one transfer at a time, anyone else leaves a note to send again
+	SEVENSEGMENT_ATOMIC {
+		_displayPending = true;
+		busy = _sending;
+		_sending = true;
+	}
+	if (busy){
+		return;
+	}
+
+	for (;;){
+
+		// Done unless asked again, a write under way sends when it ends
+		SEVENSEGMENT_ATOMIC {
+			busy = _displayPending && !_frameWriters;
+			if (busy){
+				_displayPending = false;
+			}
+			_sending = busy;
+		}
+		if (!busy){
+			break;
+		}
+
+		if (copyFrame(frame)){
+			sendFrame(frame);
+		}
+		else {
+			_displayPending = true;
+		}
+	}
+}
+
+/*
+ * Shift a frame out to the driver
+ */
+void SevenSegment::sendFrame(const uint8_t* frame){
+
 	uint8_t segmentCount = _device.segments;
 
 	// If driver is cascaded then doubles the total segment count
@@ -541,15 +2024,18 @@ void SevenSegment::display(){
 		segmentCount *= 2;
 	}
 
+#if SEVENSEGMENT_TRACE
+	traceEdge(TRACE_START);
+#endif
+
 	// Set data enable to low
-	if (_device.dataEnable){
-		digitalWrite(_pinLoad, LOW);
+	if (_device.latch == LATCH_ENABLE && _pinLoad != NO_PIN){
+		WRITE_PIN(TRACE_LOAD, _pinLoad, LOW);
 	}
 
-	// Send initial bit if required
-	if (_device.initialBit){
-		digitalWrite(_pinData, HIGH);
-		pulseClock();
+	// Send start bits if required, bit 0 first
+	for (uint8_t i = 0; i < _device.startBitCount; i++){
+		shiftBit(_device.startBits & (1 << i));
 	}
 
 	// Write data segments
@@ -557,101 +2043,355 @@ void SevenSegment::display(){
 
 		// Output data in ascending order
 		for (uint8_t i = 0; i < segmentCount; i++){
-			digitalWrite(_pinData, _data[i] ? HIGH : LOW);
-			pulseClock();
+			shiftBit(frame[i >> 3] & (1 << (i & 7)));
 		}
 	}
 	else{
 
 		// Output data in descending order
 		for (int8_t i = segmentCount - 1; i >= 0; i--){
-			digitalWrite(_pinData, _data[i] ? HIGH : LOW);
-			pulseClock();
+			shiftBit(frame[i >> 3] & (1 << (i & 7)));
 		}
 	}
 
 	// Pulse load if required
-	if (_device.pulseLoad){
+	if (_device.latch == LATCH_PULSE && _pinLoad != NO_PIN){
 		pulseLoad();
 	}
 
 	// Set data enable to high
-	if (_device.dataEnable){
-		digitalWrite(_pinLoad, HIGH);
+	if (_device.latch == LATCH_ENABLE && _pinLoad != NO_PIN){
+		WRITE_PIN(TRACE_LOAD, _pinLoad, HIGH);
 	}
 }
 
+#if SEVENSEGMENT_TRACE
+// ---------------------------------------------
+// Bus trace
+// ---------------------------------------------
+
 /*
- * Returns the mask character at current mask cursor position
+ * Write a bus pin, recording the change in the trace
  */
-uint8_t SevenSegment::getCharAtMaskCursor(){
-	return _mask[_maskCursor];
+void SevenSegment::writePin(uint8_t line, uint8_t pin, uint8_t level){
+
+	digitalWrite(pin, level);
+
+	if (((_traceLevels >> line) & 1) != (level ? 1 : 0)){
+		_traceLevels ^= 1 << line;
+		traceEdge(line | (level ? TRACE_HIGH : 0));
+	}
 }
 
 /*
- * Put character data into display array
+ * Add an entry to the trace, the oldest goes when it is full
  */
-void SevenSegment::printChar(uint8_t charToPrint, int8_t direction){
-
-	uint8_t maskChar = getCharAtMaskCursor();
-// charToPrint == '.' ||
-	if (charToPrint == ':' || charToPrint == '|'){
+void SevenSegment::traceEdge(uint8_t edge){
 
-		// display punctuation if printable at current location
-		if (canPrintAtMaskCursor(charToPrint)){
-			putChar(charToPrint);
-			_maskCursor += direction;
+	// Levels before the oldest entry are needed to draw the waveform
+	if (_traceCount == SEVENSEGMENT_TRACE_EDGES){
+		uint8_t line = _traceEdge[_traceHead] & 3;
+		if (line != TRACE_START){
+			_traceStartLevels = (_traceStartLevels & ~(1 << line)) | ((_traceEdge[_traceHead] & TRACE_HIGH ? 1 : 0) << line);
 		}
 	}
-	else if (charToPrint == ' '){
+	else {
+		_traceCount++;
+	}
 
-		// automatically clear any punctuation at current location
-		if (maskChar == '.'  || maskChar == ':'  || maskChar == '|'){
-			putChar(' ');
-			_maskCursor += direction;
+	_traceTime[_traceHead] = SEVENSEGMENT_TRACE_TIME();
+	_traceEdge[_traceHead] = edge;
+	_traceHead = (_traceHead + 1) % SEVENSEGMENT_TRACE_EDGES;
+}
+
+/*
+ * Forget everything traced so far
+ */
+void SevenSegment::clearTrace(){
+	_traceHead = 0;
+	_traceCount = 0;
+	_traceStartLevels = _traceLevels;
+}
+
+/*
+ * Nanoseconds between two trace entries, taken in the counter's width so
+ * it can wrap in between
+ */
+uint32_t SevenSegment::getTraceNs(uint8_t from, uint8_t to){
+	return (uint32_t) (SEVENSEGMENT_TRACE_TIME_T) (_traceTime[to] - _traceTime[from]) * SEVENSEGMENT_TRACE_TICK;
+}
+
+/*
+ * Write the trace as a VCD file for a waveform viewer such as GTKWave, times
+ * are from the oldest entry.  They add up entry to entry so a narrow counter
+ * only shortens gaps longer than it can count
+ */
+void SevenSegment::printTrace(Print& out){
+
+	uint8_t first = (_traceHead + SEVENSEGMENT_TRACE_EDGES - _traceCount) % SEVENSEGMENT_TRACE_EDGES;
+	uint8_t entry = first;
+	uint32_t time = 1;
+	uint32_t lastTime = 0;
+
+	out.println(F("$timescale 1ns $end"));
+	out.println(F("$scope module SevenSegment $end"));
+	out.println(F("$var wire 1 c clock $end"));
+	out.println(F("$var wire 1 d data $end"));
+	out.println(F("$var wire 1 l load $end"));
+	out.println(F("$var event 1 s transfer $end"));
+	out.println(F("$upscope $end"));
+	out.println(F("$enddefinitions $end"));
+
+	// Levels before the oldest entry
+	out.println(F("#0"));
+	out.println(F("$dumpvars"));
+	out.print(_traceStartLevels & (1 << TRACE_CLOCK) ? '1' : '0');
+	out.println('c');
+	out.print(_traceStartLevels & (1 << TRACE_DATA) ? '1' : '0');
+	out.println('d');
+	out.print(_traceStartLevels & (1 << TRACE_LOAD) ? '1' : '0');
+	out.println('l');
+	out.println(F("$end"));
+
+	for (uint8_t i = 0; i < _traceCount; i++){
+		time += getTraceNs(entry, (first + i) % SEVENSEGMENT_TRACE_EDGES);
+		entry = (first + i) % SEVENSEGMENT_TRACE_EDGES;
+
+		// Entries at the same time share a timestamp, after the starting levels at #0
+		if (time != lastTime){
+			out.print('#');
+			out.println(time);
+			lastTime = time;
 		}
-		putChar(' ');
-		_maskCursor += direction;
+
+		out.print(_traceEdge[entry] & TRACE_HIGH || (_traceEdge[entry] & 3) == TRACE_START ? '1' : '0');
+		out.println("cdls"[_traceEdge[entry] & 3]);
 	}
-	else {
+}
 
-		// try to output character at the next valid position
-		while ((direction == 1 && _maskCursor < strlen(_mask)) || (direction == -1 && _maskCursor >= 0)){
+/*
+ * Check each traced transfer against the driver's timings: clock high and
+ * low times, data set-up before and hold after each clock pulse, load pulse
+ * width, clocking only while DATA ENABLE is low, and the number of pulses and
+ * start bits.  A transfer that started before the oldest entry has its
+ * timings checked but can't be counted.  Each problem is printed to out,
+ * returns how many there were
+ */
+uint16_t SevenSegment::checkTrace(Print& out){
+
+	uint8_t first = (_traceHead + SEVENSEGMENT_TRACE_EDGES - _traceCount) % SEVENSEGMENT_TRACE_EDGES;
+	uint8_t levels = _traceStartLevels;
+	uint8_t entry;
+	uint8_t line;
+	boolean high;
+	boolean active;
+	uint16_t transfer = 0;
+	uint16_t pulses = 0;
+	uint8_t startBits = 0;
+	uint16_t violations = 0;
+	int16_t lastClock = -1;
+	int16_t lastTrailing = -1;
+	int16_t lastData = -1;
+	int16_t lastLoad = -1;
+	uint16_t expected = _device.startBitCount + (_cascaded ? 2 : 1) * _device.segments;
+	uint8_t previous = first;
+	uint32_t now = 0;
+	uint32_t ns;
+	uint32_t minimum;
+	const __FlashStringHelper* rule;
+
+	// A transfer longer than the buffer lost its start, check what is left of it
+	if (_traceCount == SEVENSEGMENT_TRACE_EDGES && (_traceEdge[first] & 3) != TRACE_START){
+		out.println(F("Transfer 0: started before the trace, pulses and start bits not checked"));
+	}
 
-			if (canPrintAtMaskCursor(charToPrint)){
-				putChar(charToPrint);
-				_maskCursor += direction;
-				break;
+	// One more pass than there are entries closes the last transfer
+	for (uint16_t i = 0; i <= _traceCount; i++){
+		entry = (first + i) % SEVENSEGMENT_TRACE_EDGES;
+		line = i < _traceCount ? _traceEdge[entry] & 3 : TRACE_START;
+		now += getTraceNs(previous, entry);
+		previous = entry;
+		high = _traceEdge[entry] & TRACE_HIGH;
+		rule = NULL;
+		ns = 0;
+		minimum = 0;
+
+		if (line == TRACE_START){
+
+			// Finish the previous transfer, one the trace starts part way through can't be counted
+			if (transfer > 0 && (pulses != expected || startBits != (_device.startBits & ((1 << _device.startBitCount) - 1)))){
+				out.print(F("Transfer "));
+				out.print(transfer);
+				out.print(F(": "));
+				out.print(pulses);
+				out.print(F(" clock pulses, start bits "));
+				out.print(startBits, BIN);
+				out.print(F(", needs "));
+				out.print(expected);
+				out.print(F(" and "));
+				out.println(_device.startBits & ((1 << _device.startBitCount) - 1), BIN);
+				violations++;
 			}
-			_maskCursor += direction;
+
+			transfer++;
+			pulses = 0;
+			startBits = 0;
+			lastClock = -1;
+			lastTrailing = -1;
+			lastLoad = -1;
+			continue;
+		}
+
+		if (line == TRACE_CLOCK){
+			active = high != _device.clockIdleHigh;
+
+			if (lastClock >= 0 && getTraceNs(lastClock, entry) < _device.clockWidth){
+				rule = active ? F("clock idle") : F("clock pulse");
+				ns = getTraceNs(lastClock, entry);
+				minimum = _device.clockWidth;
+			}
+
+			if (active){
+				if (lastData >= 0 && getTraceNs(lastData, entry) < _device.setupTime){
+					rule = F("data set-up");
+					ns = getTraceNs(lastData, entry);
+					minimum = _device.setupTime;
+				}
+				if (_device.latch == LATCH_ENABLE && _pinLoad != NO_PIN && (levels & (1 << TRACE_LOAD))){
+					rule = F("clocked while DATA ENABLE high");
+				}
+
+				// Count the pulse and note the start bits sent
+				if (pulses < _device.startBitCount && (levels & (1 << TRACE_DATA))){
+					startBits |= 1 << pulses;
+				}
+				pulses++;
+			}
+			else {
+				lastTrailing = entry;
+			}
+			lastClock = entry;
+		}
+
+		if (line == TRACE_DATA){
+			if ((levels & (1 << TRACE_CLOCK) ? 1 : 0) != (_device.clockIdleHigh ? 1 : 0)){
+				rule = F("data changed during clock pulse");
+			}
+			else if (lastTrailing >= 0 && getTraceNs(lastTrailing, entry) < _device.holdTime){
+				rule = F("data hold");
+				ns = getTraceNs(lastTrailing, entry);
+				minimum = _device.holdTime;
+			}
+			lastData = entry;
+		}
+
+		if (line == TRACE_LOAD && _device.latch == LATCH_PULSE){
+			if (high){
+				lastLoad = entry;
+			}
+			else if (lastLoad >= 0 && getTraceNs(lastLoad, entry) < _device.loadWidth){
+				rule = F("load pulse");
+				ns = getTraceNs(lastLoad, entry);
+				minimum = _device.loadWidth;
+			}
+		}
+
+		// Track the levels as they were after this entry
+		levels = (levels & ~(1 << line)) | ((high ? 1 : 0) << line);
+
+		if (rule != NULL){
+			out.print(F("Transfer "));
+			out.print(transfer);
+			out.print(F(" at "));
+			out.print(now);
+			out.print(F("ns: "));
+			out.print(rule);
+			if (minimum){
+				out.print(' ');
+				out.print(ns);
+				out.print(F("ns, needs "));
+				out.print(minimum);
+				out.print(F("ns"));
+			}
+			out.println();
+			violations++;
 		}
 	}
+
+	return violations;
+}
+#endif
+
+/*
+ * Returns the mask character at current mask cursor position
+ */
+uint8_t SevenSegment::getCharAtMaskCursor(){
+
+	// Nothing can be printed outside the mask
+	if (_maskCursor < 0 || _maskCursor >= _maskLength){
+		return 0;
+	}
+
+	// Nothing can be printed at a reserved position either
+	if (isReserved(_maskCursor)){
+		return RESERVED_CHAR;
+	}
+	return _mask[_maskCursor];
 }
 
 /*
- * Can we output specified character at current mask position
+ * Lay one character out at the mask cursor and move the cursor on, in a
+ * single step per character:
+ *
+ *  : and |  fold into the punctuation at the cursor, or are dropped
+ *  space    blanks the position, skipping any punctuation before it
+ *  others   go in the next position in direction that can show them, so
+ *           a . finds the next point and a digit skips unused punctuation
+ *
+ * Reserved positions are stepped over.  Only used on cleared screen data, so
+ * blanks don't need writing
  */
-boolean SevenSegment::canPrintAtMaskCursor(uint8_t charToPrint){
+void SevenSegment::printChar(uint8_t charToPrint, int8_t direction){
 
 	uint8_t maskChar = getCharAtMaskCursor();
 
-	if (maskChar == '8'){
-		if (charToPrint != '.' && charToPrint != ':' && charToPrint != '|'){
-			return true;
-		}
+	while (maskChar == RESERVED_CHAR){
+		_maskCursor += direction;
+		maskChar = getCharAtMaskCursor();
 	}
-	else if (maskChar == '|'){
-		if (charToPrint == ':' || charToPrint == '.' || charToPrint == '|' || charToPrint == ' '){
-			return true;
+
+	switch (charToPrint){
+	case ':':
+	case '|':
+		if (maskChar == charToPrint || maskChar == '|'){
+			putBits(maskChar, charToPrint);
+			_maskCursor += direction;
 		}
-	}
-	else if (maskChar == '.' ||  maskChar == ':' || maskChar == '-' || maskChar == '1' ){
-		if (charToPrint == maskChar || charToPrint == ' '){
-			return true;
+		break;
+
+	case ' ':
+		if (maskChar == '.'  || maskChar == ':'  || maskChar == '|'){
+			_maskCursor += direction;
+			while (getCharAtMaskCursor() == RESERVED_CHAR){
+				_maskCursor += direction;
+			}
 		}
-	}
+		if (_maskCursor >= 0 && _maskCursor < _maskLength){
+			_maskCursor += direction;
+		}
+		break;
 
-	return false;
+	default:
+		while (maskChar != 0){
+			if (maskChar != RESERVED_CHAR && (maskChar == '8' ? charToPrint != '.' : (maskChar == charToPrint || (maskChar == '|' && charToPrint == '.')))){
+				putBits(maskChar, charToPrint);
+				_maskCursor += direction;
+				break;
+			}
+			_maskCursor += direction;
+			maskChar = getCharAtMaskCursor();
+		}
+	}
 }
 
 /*
@@ -659,14 +2399,20 @@ boolean SevenSegment::canPrintAtMaskCursor(uint8_t charToPrint){
  */
 void SevenSegment::printError(){
 
+	beginFrameWrite();
+#if SEVENSEGMENT_BAR_GRAPH
+	setBarLevel(0);
+#endif
+	filterChanged(-1);
 	_maskCursor = 0;
-	for (uint8_t c = 0; c < strlen(_mask); c++){
-		if (_mask[c] == '8' || _mask[c] == '-'){
+	for (uint8_t c = 0; c < _maskLength; c++){
+		if ((_mask[c] == '8' || _mask[c] == '-') && !isReserved(c)){
 			putChar('-');
 		}
 		_maskCursor++;
 	}
-	display();
+	endFrameWrite();
+	displayIfShown();
 }
 
 /*
@@ -675,72 +2421,102 @@ void SevenSegment::printError(){
 void SevenSegment::putChar(uint8_t c){
 
 	uint8_t maskChar = getCharAtMaskCursor();
-	uint8_t index = getMaskCursorIndex();
-	uint8_t dataBits;
-	uint8_t bitCount = getMaskCharBitCount(maskChar);
 
-	// What data we need to store and pack into correct number of bits
+	writeBits(getMaskCursorIndex(), getMaskCharBits(maskChar, c), getMaskCharBitCount(maskChar));
+}
+
+/*
+ * Set the bits for a character at the current position, for cleared screen data
+ */
+void SevenSegment::putBits(uint8_t maskChar, uint8_t c){
+
+	uint8_t dataBits = getMaskCharBits(maskChar, c);
+
+	if (dataBits){
+		writeBits(getMaskCursorIndex(), dataBits, getMaskCharBitCount(maskChar));
+	}
+}
+
+/*
+ * What data to store for a character, packed into the bits the mask character uses
+ */
+uint8_t SevenSegment::getMaskCharBits(uint8_t maskChar, uint8_t c){
+
 	switch (maskChar){
 	case '8':
-		dataBits = getSegmentByte(c);
-		break;
+		return getSegmentByte(c);
 	case '|':
 		if (c == '.')
-			dataBits = B00000001;
+			return B00000001;
 		else if (c == ':')
-			dataBits = B00000010;
+			return B00000010;
 		else if (c == '|')
-			dataBits = B00000011;
+			return B00000011;
 		else
-			dataBits = 0;
-		break;
+			return 0;
 	case '.':
 	case ':':
 	case '-':
 	case '1':
-		if (c != ' ')
-			dataBits = 1;
-		else
-			dataBits = 0;
-		break;
+		return c != ' ' ? 1 : 0;
 	}
+	return 0;
+}
 
-#if SERIAL_MESSAGES_ON > 0
-	Serial.print("Char to print is ");
-	Serial.print(c, BYTE);Serial.print("(");Serial.print(c, DEC);Serial.print(")");
-	Serial.print(" at index ");
-	Serial.print(index, DEC);
-	Serial.print(".  Maskchar is ");
-	Serial.println(maskChar);
-#endif
-
-	// Put data into our segment array
-	for (uint8_t i = 0; i < bitCount; i++) {
-		_data[index + i] = dataBits & (1 << i) ? true : false;
+/*
+ * Write up to 8 bits into screen data starting at index, a byte or two at a time
+ */
+void SevenSegment::writeBits(uint8_t index, uint8_t bits, uint8_t bitCount){
+
+	uint8_t* data = &_data[_editPage][index >> 3];
+	uint8_t shift = index & 7;
+	uint16_t mask = ((1 << bitCount) - 1) << shift;
+	uint16_t value = (uint16_t) bits << shift;
+
+	// Other bits in these bytes may belong to a field an interrupt changes
+	SEVENSEGMENT_ATOMIC {
+		data[0] = (data[0] & ~mask) | (value & mask);
+		if (mask >> 8){
+			data[1] = (data[1] & ~(mask >> 8)) | ((value & mask) >> 8);
+		}
 	}
 }
 
-
 /*
  * Returns where our cursor position is.  0 is the first character on the left
  */
 uint8_t SevenSegment::getMaskCursorIndex(){
+	return getMaskIndex(_maskCursor);
+}
 
-	uint8_t index = 0;
-
+/*
+ * Returns where the data for a mask position starts in the data array
+ */
+uint8_t SevenSegment::getMaskIndex(uint8_t position){
 
-	// Calculate mask element position in array
-	if (_wiring == LEFT_TO_RIGHT) {
-		for (uint8_t c = 0; c < _maskCursor; c++) {
-			index += getMaskCharBitCount(_mask[c]);
-		}
+	// Offsets were worked out left to right by begin()
+	if (!_maskReversed) {
+		return _maskOffset[position];
 	}
 	else {
-		for (uint8_t c = strlen(_mask) - 1; c > _maskCursor; c--) {
-			index += getMaskCharBitCount(_mask[c]);
+		return _maskBits - _maskOffset[position] - getMaskCharBitCount(_mask[position]);
+	}
+}
+
+/*
+ * Mask position a screen data segment belongs to, -1 if none
+ */
+int8_t SevenSegment::getSegmentPosition(uint8_t segment){
+
+	uint8_t index;
+
+	for (uint8_t i = 0; i < _maskLength; i++){
+		index = getMaskIndex(i);
+		if (segment >= index && segment < index + getMaskCharBitCount(_mask[i])){
+			return i;
 		}
 	}
-	return index;
+	return -1;
 }
 
 /*
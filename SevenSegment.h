@@ -1,7 +1,9 @@
 #ifndef SevenSegment_h
 #define SevenSegment_h
 
-#define SEVENSEGMENT_LIB_VERSION "1.0"
+#define SEVENSEGMENT_LIB_VERSION "1.1"
+
+#include "SevenSegmentConfig.h"
 
 #if ARDUINO >= 100
   #include "Arduino.h"
@@ -26,14 +28,118 @@ enum wiring_t {
 };
 
 /*
- * 7 segment display class
+ * Which way up the screen is seen.  Rotated is upside down, mirrored is seen
+ * in a mirror and flipped is upside down in a mirror
+ */
+enum orientation_t {
+	ORIENTATION_NORMAL,
+	ORIENTATION_ROTATED,
+	ORIENTATION_MIRRORED,
+	ORIENTATION_FLIPPED
+};
+
+/*
+ * Built in display drivers
+ */
+enum driver_id_t {
+	DRIVER_M5450,
+	DRIVER_M5451,
+	DRIVER_MM5452,
+	DRIVER_MM5453,
+	DRIVER_AY0438,
+	DRIVER_BT_M512RD_DR1,
+	DRIVER_COUNT
+};
+
+/*
+ * How a driver moves shifted data onto its outputs
+ */
+enum latch_t {
+	LATCH_NONE,	// Latched by the driver once the last bit is in
+	LATCH_PULSE,	// Load pin pulsed high after the last bit
+	LATCH_ENABLE	// Load pin held low while shifting (DATA ENABLE)
+};
+
+/*
+ * Display driver description.  Declare one PROGMEM and pass it to begin() to
+ * drive other shift register chips.  Times are in nanoseconds
+ */
+struct driver_t {
+	const char* name;		// Name, stored in PROGMEM
+	uint8_t segments;		// Outputs on one chip
+	uint8_t latch;			// latch_t
+	boolean segmentsOrderInc;	// Segment 0 is sent first, otherwise last
+	boolean cascadable;		// Two chips can be chained for double the segments
+	boolean clockIdleHigh;		// Clock rests high and pulses low
+	uint8_t startBits;		// Pattern sent before the segments, bit 0 first
+	uint8_t startBitCount;		// Number of start bits, up to 8
+	uint16_t clockWidth;		// Minimum clock high and low time
+	uint16_t setupTime;		// Data stable before clock pulse
+	uint16_t holdTime;		// Data stable after clock pulse
+	uint16_t loadWidth;		// Minimum load pulse
+};
+
+/*
+ * Segments of a digit, and of punctuation (. or : is SEG_A, the colon in | is SEG_B)
+ */
+enum segment_t {
+	SEG_A,
+	SEG_B,
+	SEG_C,
+	SEG_D,
+	SEG_E,
+	SEG_F,
+	SEG_G
+};
+
+/*
+ * One entry in a bar graph list: segment of the character at a mask position
+ */
+#define BAR_SEGMENT(position, segment) ((uint8_t) (((position) << 3) | (segment)))
+
+/*
+ * How printFiltered() smooths readings
+ */
+enum smoothing_t {
+	SMOOTH_NONE,
+	SMOOTH_AVERAGE,	// Average of the last few readings
+	SMOOTH_EMA	// Exponential moving average
+};
+
+/*
+ * Reason begin() failed, see getSetupError() and getSetupErrorPosition()
+ */
+enum setup_error_t {
+	SETUP_OK,
+	SETUP_UNKNOWN_DRIVER,
+	SETUP_MASK_EMPTY,
+	SETUP_MASK_TOO_LONG,
+	SETUP_INVALID_CHARACTER,
+	SETUP_MISPLACED_MINUS,
+	SETUP_MISPLACED_ONE,
+	SETUP_REPEATED_PUNCTUATION,
+	SETUP_TOO_MANY_SEGMENTS
+};
+
+/*
+ * 7 segment display class, also an Arduino Print so print(), println() and
+ * friends can be used.  Those stream into the screen and are sent by
+ * println() or commit()
  */
-class SevenSegment{
+#if SEVENSEGMENT_PRINT_CLASS
+class SevenSegment : public Print{
+#else
+class SevenSegment {
+#endif
 	public:
 		SevenSegment(uint8_t clock, uint8_t data);
 		SevenSegment(uint8_t clock, uint8_t data, uint8_t load);
 
+#if SEVENSEGMENT_DRIVER_NAMES
 		boolean begin(const char* driverName, const char* screenMask);
+#endif
+		boolean begin(driver_id_t driver, const char* screenMask);
+		boolean begin(const driver_t* driver, const char* screenMask);
 
 		void clear();
 		void on();
@@ -42,54 +148,244 @@ class SevenSegment{
 
 		boolean getSegment(uint8_t segment);
 
+		setup_error_t getSetupError();
+		int8_t getSetupErrorPosition();
+		uint32_t getMaximum();
+		int32_t getMinimum();
+		uint8_t getDigitCount();
+
 		void setWiring(wiring_t wiring);
 		void setSegment(uint8_t segment, boolean value);
+		void setCharacter(uint8_t position, char c);
+		void setReserved(uint8_t position, boolean reserved);
 		void setAlignment(alignment_t alignment);
 		void setZeroPadding(boolean padding);
 		void setCascaded(boolean cascaded);
+#if SEVENSEGMENT_ORIENTATION
+		boolean setOrientation(orientation_t orientation);
+#endif
+
+#if SEVENSEGMENT_BLINK
+		void setBlink(uint8_t position, boolean blink);
+		void setBlinkRate(uint16_t rate);
+		void clearBlink();
+#endif
+		boolean update();
+		void calibrateTiming();
+
+#if SEVENSEGMENT_TRACE
+		void clearTrace();
+		void printTrace(Print& out);
+		uint16_t checkTrace(Print& out);
+#endif
+
+		void setPage(uint8_t page);
+		void showPage(uint8_t page);
+		uint8_t getPage();
+		void setPageRotation(uint8_t count, uint16_t interval);
+
+#if SEVENSEGMENT_PRINT_CLASS
+		using Print::print;
+#endif
+		void print(const char* s);
+#if ARDUINO >= 100
+		void print(const __FlashStringHelper* s);
+#endif
+		void printAlignedLeft(const char* s);
+		void printAlignedRight(const char* s);
 
-		void print(char* s);
-		void printAlignedLeft(char* s);
-		void printAlignedRight(char* s);
+#if SEVENSEGMENT_PRINT_CLASS
+		using Print::write;
+#if ARDUINO >= 100
+		virtual size_t write(uint8_t c);
+#else
+		virtual void write(uint8_t c);
+#endif
+		virtual void flush();
+		void commit();
+#endif
 
+#if SEVENSEGMENT_UNSIGNED
 		void printNumber(uint8_t v);
 		void printNumber(uint16_t v);
 		void printNumber(uint32_t v);
+#endif
 
+#if SEVENSEGMENT_SIGNED
 		void printNumber(int8_t v);
 		void printNumber(int16_t v);
 		void printNumber(int32_t v);
+#endif
+
+#if SEVENSEGMENT_FILTER
+		void setFilter(uint16_t deadband, uint16_t holdTime);
+		void setSmoothing(smoothing_t smoothing, uint8_t amount);
+		boolean printFiltered(int32_t v);
+		boolean printFiltered(int32_t v, uint8_t decimals);
+#endif
+
+#if SEVENSEGMENT_COUNTER
+		void setCounter(uint32_t v);
+		uint32_t getCounter();
+		void increment();
+		void decrement();
+		void add(int32_t n);
+#endif
+
+#if SEVENSEGMENT_BAR_GRAPH
+		boolean setBarGraph(const uint8_t* segments, uint8_t count);
+		void setBarLevel(uint8_t level);
+		void setBarValue(uint16_t value, uint16_t maximum);
+#endif
 
 	private:
 		uint8_t		_pinClock;
 		uint8_t		_pinData;
 		uint8_t		_pinLoad;
 
-		boolean		_data[64];
+		driver_t	_device;
+		uint16_t	_writeTime;
+		uint16_t	_spinTime;
+		uint16_t	_clockSpins;
+		uint16_t	_setupSpins;
+		uint16_t	_holdSpins;
+		uint16_t	_loadSpins;
+
+		uint8_t		_data[SEVENSEGMENT_PAGES][8];
+		volatile uint8_t _frameSequence;
+		volatile uint8_t _frameWriters;
+		volatile boolean _displayPending;
+		volatile boolean _sending;
+		uint8_t		_editPage;
+		uint8_t		_shownPage;
+		uint8_t		_pageCount;
+		uint16_t	_pageInterval;
+		uint32_t	_pageTime;
+#if SEVENSEGMENT_BLINK
+		uint8_t		_blink[8];
+		boolean		_blinkOff;
+		uint16_t	_blinkRate;
+		uint32_t	_blinkTime;
+#endif
 		boolean		_cascaded;
 		int8_t		_maskCursor;
+#if SEVENSEGMENT_PRINT_CLASS
+		boolean		_streamOpen;
+		uint8_t		_streamLength;
+		char		_stream[32];
+#endif
 		char		_mask[32];
+		uint8_t		_maskOffset[32];
+		uint8_t		_maskLength;
+		uint8_t		_maskBits;
+		uint8_t		_digitCount;
+		boolean		_maskHasMinus;
+		boolean		_maskHasOne;
+		uint32_t	_reserved;
+#if SEVENSEGMENT_COUNTER
+		uint8_t		_digitPosition[10];
+		uint8_t		_counter[10];
+		uint8_t		_counterTop;
+#endif
+#if SEVENSEGMENT_FILTER
+		boolean		_filterShown;
+		uint8_t		_filterPage;
+		int32_t		_filterValue;
+		uint8_t		_filterDecimals;
+		uint16_t	_filterDeadband;
+		uint16_t	_filterHold;
+		uint32_t	_filterTime;
+		smoothing_t	_smoothing;
+		uint8_t		_smoothingAmount;
+		int32_t		_smoothingSum;
+		int32_t		_smoothingSamples[8];
+		uint8_t		_smoothingCount;
+		uint8_t		_smoothingIndex;
+#endif
+#if SEVENSEGMENT_BAR_GRAPH
+		const uint8_t*	_bar;
+		uint8_t		_barCount;
+		uint8_t		_barLevel;
+#endif
+#if SEVENSEGMENT_TRACE
+		SEVENSEGMENT_TRACE_TIME_T _traceTime[SEVENSEGMENT_TRACE_EDGES];
+		uint8_t		_traceEdge[SEVENSEGMENT_TRACE_EDGES];
+		uint8_t		_traceHead;
+		uint8_t		_traceCount;
+		uint8_t		_traceLevels;
+		uint8_t		_traceStartLevels;
+#endif
+		setup_error_t	_setupError;
+		int8_t		_setupErrorPosition;
 		uint32_t	_overflow;
 		int32_t		_underflow;
 		alignment_t	_alignment;
 		boolean		_zeroPadding;
 		wiring_t	_wiring;
+		boolean		_maskReversed;
+#if SEVENSEGMENT_ORIENTATION
+		orientation_t	_orientation;
+		const unsigned char* _segmentMap;
+#endif
 
 		char* trimZeroes(char* pString);
 
 		void putChar(uint8_t c);
+		void putBits(uint8_t maskChar, uint8_t c);
+		void writeBits(uint8_t index, uint8_t bits, uint8_t bitCount);
+		void printLeft(const char* s, boolean flash);
+		void printRight(const char* s, boolean flash);
+#if SEVENSEGMENT_PRINT_CLASS
+		void streamChar(uint8_t c);
+#endif
+		uint8_t readChar(const char* p, boolean flash);
 		void printChar(uint8_t charToPrint, int8_t direction);
 		void clearData();
+		boolean isReserved(uint8_t position);
+		void filterChanged(int8_t position);
+#if SEVENSEGMENT_COUNTER
+		void showCounter(uint8_t last);
+#endif
+#if SEVENSEGMENT_BAR_GRAPH
+		uint8_t getBarIndex(uint8_t entry);
+#endif
+#if SEVENSEGMENT_FILTER
+		int32_t smooth(int32_t v);
+		void printFixed(int32_t v, uint8_t decimals);
+		boolean hasPointAfterDigit(uint8_t digit);
+#endif
+		void displayIfShown();
+		void beginFrameWrite();
+		void endFrameWrite();
+		boolean copyFrame(uint8_t* frame);
+		void sendFrame(const uint8_t* frame);
+#if SEVENSEGMENT_TRACE
+		void writePin(uint8_t line, uint8_t pin, uint8_t level);
+		void traceEdge(uint8_t edge);
+		uint32_t getTraceNs(uint8_t from, uint8_t to);
+#endif
 		void pulseClock();
 		void pulseLoad();
+		void shiftBit(boolean value);
+		void spinWait(uint16_t count);
+		uint16_t getSpins(uint16_t ns);
 
 		uint8_t getSegmentByte(uint8_t character);
 		uint8_t getCharAtMaskCursor();
 		uint8_t getMaskCursorIndex();
+		uint8_t getMaskIndex(uint8_t position);
+		int8_t getSegmentPosition(uint8_t segment);
 		uint8_t getMaskCharBitCount(uint8_t maskCharacter);
+		uint8_t getMaskCharBits(uint8_t maskChar, uint8_t c);
 
-		boolean calculateDisplayRange();
-		boolean canPrintAtMaskCursor(uint8_t charToPrint);
+		boolean calculateDisplayRange(const char* screenMask);
+		void calculateNumberRange();
+		void findDigitPositions();
+#if SEVENSEGMENT_ORIENTATION
+		void reverseMask();
+		uint8_t getOrientedSegment(uint8_t segment);
+#endif
+		boolean setupFailed(setup_error_t error, int8_t position);
 };
 
 #endif
@@ -0,0 +1,125 @@
+#ifndef SevenSegmentConfig_h
+#define SevenSegmentConfig_h
+
+/*
+ * Compile time options.  Everything is on by default; turn off what a sketch
+ * doesn't use to save flash and RAM.  Each option can be changed here or
+ * given as a build flag (-DSEVENSEGMENT_COUNTER=0).  Defining them in the
+ * sketch doesn't work as the library is compiled on its own.
+ *
+ * Setting SEVENSEGMENT_PROFILE picks a starting point, options given
+ * separately still win.  See README.TXT for what each one saves
+ */
+
+#define SEVENSEGMENT_PROFILE_FULL 0	// Everything
+#define SEVENSEGMENT_PROFILE_MINIMAL 1	// Digits on one page printed with printNumber() or print()
+
+#ifndef SEVENSEGMENT_PROFILE
+  #define SEVENSEGMENT_PROFILE SEVENSEGMENT_PROFILE_FULL
+#endif
+
+#if SEVENSEGMENT_PROFILE == SEVENSEGMENT_PROFILE_MINIMAL
+  #define SEVENSEGMENT_DEFAULT 0
+#else
+  #define SEVENSEGMENT_DEFAULT 1
+#endif
+
+/*
+ * Built in drivers, a driver that is left out fails begin() as unknown
+ */
+#ifndef SEVENSEGMENT_DRIVER_M5450
+  #define SEVENSEGMENT_DRIVER_M5450 1
+#endif
+#ifndef SEVENSEGMENT_DRIVER_M5451
+  #define SEVENSEGMENT_DRIVER_M5451 1
+#endif
+#ifndef SEVENSEGMENT_DRIVER_MM5452
+  #define SEVENSEGMENT_DRIVER_MM5452 1
+#endif
+#ifndef SEVENSEGMENT_DRIVER_MM5453
+  #define SEVENSEGMENT_DRIVER_MM5453 1
+#endif
+#ifndef SEVENSEGMENT_DRIVER_AY0438
+  #define SEVENSEGMENT_DRIVER_AY0438 1
+#endif
+#ifndef SEVENSEGMENT_DRIVER_BT_M512RD_DR1
+  #define SEVENSEGMENT_DRIVER_BT_M512RD_DR1 1
+#endif
+
+/*
+ * Features
+ */
+#ifndef SEVENSEGMENT_DRIVER_NAMES
+  #define SEVENSEGMENT_DRIVER_NAMES SEVENSEGMENT_DEFAULT	// begin("AY0438", ...), otherwise use DRIVER_AY0438
+#endif
+#ifndef SEVENSEGMENT_FULL_CHARSET
+  #define SEVENSEGMENT_FULL_CHARSET SEVENSEGMENT_DEFAULT	// Letters and symbols, otherwise only digits, - and space
+#endif
+#ifndef SEVENSEGMENT_MASK_CHECKS
+  #define SEVENSEGMENT_MASK_CHECKS SEVENSEGMENT_DEFAULT	// begin() rejects badly formed masks
+#endif
+#ifndef SEVENSEGMENT_UNSIGNED
+  #define SEVENSEGMENT_UNSIGNED 1				// printNumber() of unsigned values
+#endif
+#ifndef SEVENSEGMENT_SIGNED
+  #define SEVENSEGMENT_SIGNED SEVENSEGMENT_DEFAULT		// printNumber() of signed values
+#endif
+#ifndef SEVENSEGMENT_PRINT_CLASS
+  #define SEVENSEGMENT_PRINT_CLASS SEVENSEGMENT_DEFAULT	// Arduino Print: print(3.5), println() and friends
+#endif
+#ifndef SEVENSEGMENT_BLINK
+  #define SEVENSEGMENT_BLINK SEVENSEGMENT_DEFAULT		// setBlink()
+#endif
+#ifndef SEVENSEGMENT_COUNTER
+  #define SEVENSEGMENT_COUNTER SEVENSEGMENT_DEFAULT		// setCounter(), increment() and friends
+#endif
+#ifndef SEVENSEGMENT_ORIENTATION
+  #define SEVENSEGMENT_ORIENTATION SEVENSEGMENT_DEFAULT	// setOrientation(), 3 more character maps
+#endif
+#ifndef SEVENSEGMENT_FILTER
+  #define SEVENSEGMENT_FILTER SEVENSEGMENT_SIGNED		// printFiltered(), needs SEVENSEGMENT_SIGNED
+#endif
+#ifndef SEVENSEGMENT_BAR_GRAPH
+  #define SEVENSEGMENT_BAR_GRAPH SEVENSEGMENT_DEFAULT	// setBarGraph()
+#endif
+
+/*
+ * Bus trace for finding glitches, off in every profile.  Records the last
+ * SEVENSEGMENT_TRACE_EDGES clock, data and load changes (5 bytes of RAM each)
+ * timed by SEVENSEGMENT_TRACE_TIME() in ticks of SEVENSEGMENT_TRACE_TICK ns,
+ * kept as SEVENSEGMENT_TRACE_TIME_T so a narrower counter wraps correctly.
+ * micros() steps 4us on a 16MHz board, too coarse to check 300ns timings, so
+ * use a faster timer there: with TCCR1A = 0 and TCCR1B = 1 use TCNT1, a
+ * uint16_t and a tick of 62 (62.5 rounded down so times are never flattered,
+ * 3 bytes of RAM each).  A transfer longer than the buffer is checked from
+ * where the trace starts
+ */
+#ifndef SEVENSEGMENT_TRACE
+  #define SEVENSEGMENT_TRACE 0
+#endif
+#ifndef SEVENSEGMENT_TRACE_EDGES
+  #define SEVENSEGMENT_TRACE_EDGES 128 // Up to 255
+#endif
+#ifndef SEVENSEGMENT_TRACE_TIME
+  #define SEVENSEGMENT_TRACE_TIME() micros()
+#endif
+#ifndef SEVENSEGMENT_TRACE_TIME_T
+  #define SEVENSEGMENT_TRACE_TIME_T uint32_t
+#endif
+#ifndef SEVENSEGMENT_TRACE_TICK
+  #define SEVENSEGMENT_TRACE_TICK 1000
+#endif
+
+#if SEVENSEGMENT_FILTER && !SEVENSEGMENT_SIGNED
+  #error SEVENSEGMENT_FILTER needs SEVENSEGMENT_SIGNED
+#endif
+
+#ifndef SEVENSEGMENT_PAGES
+  #if SEVENSEGMENT_PROFILE == SEVENSEGMENT_PROFILE_MINIMAL
+    #define SEVENSEGMENT_PAGES 1
+  #else
+    #define SEVENSEGMENT_PAGES 4 // Number of screens of data kept, 8 bytes of RAM each
+  #endif
+#endif
+
+#endif
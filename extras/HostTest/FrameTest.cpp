@@ -0,0 +1,122 @@
+/*
+ * Two producers sharing one screen, with threads standing in for a timer
+ * interrupt and the main loop.  The main loop prints 0000, 1111 ... 9999 as
+ * fast as it can while the "interrupt" keeps the point it reserved lit and
+ * calls display().  Every frame latched by the driver must show four equal
+ * digits (or none) and the point
+ */
+#include <atomic>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+#include "SevenSegment.h"
+
+#define PIN_CLOCK 1
+#define PIN_DATA 2
+#define PIN_LOAD 3
+
+#define PRINTS 50000
+
+static const uint8_t digitSegments[10] = { 0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F };
+
+static SevenSegment screen(PIN_CLOCK, PIN_DATA, PIN_LOAD);
+
+static uint8_t pins[4];
+static std::vector<uint8_t> bits;
+static long frames = 0;
+static long torn = 0;
+static long wrongLength = 0;
+static long noPoint = 0;
+
+/*
+ * Check a frame as the AY0438 latches it, last segment first
+ */
+static void checkFrame(){
+
+	uint8_t segments[32];
+	int digit[4];
+
+	frames++;
+	if (bits.size() != 32){
+		wrongLength++;
+		return;
+	}
+	for (uint8_t i = 0; i < 32; i++){
+		segments[31 - i] = bits[i];
+	}
+
+	// "8888." is four digits of 7 segments then the point
+	for (uint8_t d = 0; d < 4; d++){
+		uint8_t glyph = 0;
+		for (uint8_t s = 0; s < 7; s++){
+			glyph |= segments[d * 7 + s] << s;
+		}
+		digit[d] = glyph == 0 ? -2 : -1;
+		for (uint8_t n = 0; n < 10; n++){
+			if (digitSegments[n] == glyph){
+				digit[d] = n;
+			}
+		}
+	}
+
+	if (!(digit[0] == -2 && digit[1] == -2 && digit[2] == -2 && digit[3] == -2) &&
+		!(digit[0] >= 0 && digit[0] == digit[1] && digit[1] == digit[2] && digit[2] == digit[3])){
+		if (torn < 5){
+			printf("torn frame %d %d %d %d\n", digit[0], digit[1], digit[2], digit[3]);
+		}
+		torn++;
+	}
+	if (!segments[28]){
+		noPoint++;
+	}
+}
+
+/*
+ * Bus decoder: data is taken on the clock's rising edge and a load pulse
+ * latches the frame
+ */
+static void pinWritten(uint8_t pin, uint8_t level){
+
+	if (pin == PIN_CLOCK && level && !pins[PIN_CLOCK]){
+		bits.push_back(pins[PIN_DATA]);
+	}
+	if (pin == PIN_LOAD && level && !pins[PIN_LOAD]){
+		checkFrame();
+		bits.clear();
+	}
+	pins[pin] = level;
+}
+
+int main(){
+
+	std::atomic<bool> stop(false);
+
+	if (!screen.begin(DRIVER_AY0438, "8888.")){
+		printf("begin() failed\n");
+		return 1;
+	}
+	screen.setAlignment(RIGHT);
+	screen.setZeroPadding(true);
+	screen.setReserved(4, true);
+	screen.setCharacter(4, '.');
+
+	// Frames from here on are checked
+	hostPinWrite = pinWritten;
+
+	std::thread interrupt([&]{
+		while (!stop){
+			screen.setCharacter(4, '.');
+			screen.display();
+			std::this_thread::yield();
+		}
+	});
+
+	for (long i = 0; i < PRINTS; i++){
+		screen.printNumber((uint16_t) ((i % 10) * 1111));
+	}
+	stop = true;
+	interrupt.join();
+
+	printf("frames %ld, torn %ld, wrong length %ld, point missing %ld\n", frames, torn, wrongLength, noPoint);
+	return torn || wrongLength || noPoint ? 1 : 0;
+}
@@ -0,0 +1,88 @@
+/*
+ * Bus trace checker against host recordings.  Every built in driver sent with
+ * pin changes as far apart as the slowest driver needs must pass, and the
+ * same transfers timed as if the board were far too fast for the driver must
+ * not, including a transfer too long for the trace buffer.  Built with
+ * SEVENSEGMENT_TRACE on and timed by a stepped hostNanos() so the result
+ * doesn't depend on how busy the machine is
+ */
+#include <stdio.h>
+#include <string>
+#include "SevenSegment.h"
+
+#define PIN_CLOCK 1
+#define PIN_DATA 2
+#define PIN_LOAD 3
+
+#define SLOW_STEP 1000 // Nanoseconds between pin changes, the longest driver minimum
+#define FAST_STEP 100 // Nanoseconds between pin changes on the too fast board
+
+/*
+ * Print into a string
+ */
+class StringPrint : public Print {
+	public:
+		std::string text;
+
+		virtual size_t write(uint8_t c){
+			text += (char) c;
+			return 1;
+		}
+};
+
+static int failures = 0;
+
+/*
+ * Send two readings and check the trace of the second, printing what was
+ * found if it isn't what was expected.  whole is false where the trace can't
+ * hold a transfer
+ */
+static void checkDriver(driver_id_t driver, const char* mask, boolean whole, boolean fast, const char* expected){
+
+	SevenSegment screen(PIN_CLOCK, PIN_DATA, PIN_LOAD);
+	StringPrint report;
+	StringPrint vcd;
+	uint16_t violations;
+
+	hostNanosStep = 0;
+	if (!screen.begin(driver, mask)){
+		printf("driver %d: begin(\"%s\") failed\n", driver, mask);
+		failures++;
+		return;
+	}
+
+	hostNanosStep = fast ? FAST_STEP : SLOW_STEP;
+	screen.print("12.34");
+	screen.clearTrace();
+	screen.print("56.78");
+	violations = screen.checkTrace(report);
+	screen.printTrace(vcd);
+	hostNanosStep = 0;
+
+	if (vcd.text.find("$enddefinitions $end") == std::string::npos || (whole && vcd.text.find("1s") == std::string::npos)){
+		printf("driver %d \"%s\": VCD has no header or transfers\n", driver, mask);
+		failures++;
+	}
+
+	// A transfer the trace holds must have its pulses and start bits counted
+	if ((violations > 0) != fast || (expected != NULL && report.text.find(expected) == std::string::npos) ||
+		(whole && report.text.find("started before the trace") != std::string::npos)){
+		printf("driver %d \"%s\" %s: %u violations\n%s", driver, mask, fast ? "fast" : "slow", violations, report.text.c_str());
+		failures++;
+	}
+}
+
+int main(){
+
+	for (uint8_t driver = 0; driver < DRIVER_COUNT; driver++){
+		checkDriver((driver_id_t) driver, "8.8.8.8", true, false, NULL);
+		checkDriver((driver_id_t) driver, "8.8.8.8", true, true, "clock pulse");
+	}
+
+	// Two cascaded chips send more edges than the trace holds
+	checkDriver(DRIVER_AY0438, "88:88:88", false, false, "started before the trace");
+	checkDriver(DRIVER_AY0438, "88:88:88", false, true, "started before the trace");
+
+	printf("trace checks %s\n", failures ? "FAILED" : "passed");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,40 @@
+/*
+ * Just enough of the Arduino core to build the library on Linux for the
+ * host tests.  Pin writes are passed to hostPinWrite, times come from the
+ * system clock and interrupts are a lock so threads can stand in for an
+ * interrupt and the main loop
+ */
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "binary.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+unsigned long millis();
+unsigned long micros();
+void noInterrupts();
+void interrupts();
+
+// Called for every digitalWrite(), set by the test
+extern void (*hostPinWrite)(uint8_t pin, uint8_t level);
+
+// Nanosecond clock for the bus trace.  When hostNanosStep isn't 0 each call
+// moves it on by that much instead, so the test picks how fast the board is
+uint32_t hostNanos();
+extern uint32_t hostNanosStep;
+
+#include "Print.h"
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * Host stand ins for the Arduino core functions
+ */
+#include "Arduino.h"
+#include <chrono>
+#include <mutex>
+
+void (*hostPinWrite)(uint8_t pin, uint8_t level) = NULL;
+uint32_t hostNanosStep = 0;
+
+// Interrupts off is holding the lock, per thread like the flag per CPU
+static std::mutex interruptLock;
+static thread_local boolean interruptsOff = false;
+
+static std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+void pinMode(uint8_t pin, uint8_t mode){
+}
+
+void digitalWrite(uint8_t pin, uint8_t level){
+	if (hostPinWrite != NULL){
+		hostPinWrite(pin, level);
+	}
+}
+
+unsigned long micros(){
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long millis(){
+	return micros() / 1000;
+}
+
+uint32_t hostNanos(){
+
+	static uint32_t stepped = 0;
+
+	if (hostNanosStep){
+		return stepped += hostNanosStep;
+	}
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void noInterrupts(){
+	if (!interruptsOff){
+		interruptLock.lock();
+		interruptsOff = true;
+	}
+}
+
+void interrupts(){
+	if (interruptsOff){
+		interruptsOff = false;
+		interruptLock.unlock();
+	}
+}
@@ -0,0 +1,92 @@
+/*
+ * Arduino Print for the host tests, printing to anything with write()
+ */
+#ifndef Print_h
+#define Print_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+// Flash strings are ordinary strings on the host
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+
+class Print {
+	public:
+		virtual ~Print() {}
+
+		virtual size_t write(uint8_t c) = 0;
+		virtual size_t write(const uint8_t* buffer, size_t size){
+			size_t n = 0;
+			while (size--){
+				n += write(*buffer++);
+			}
+			return n;
+		}
+		size_t write(const char* s){
+			return write((const uint8_t*) s, strlen(s));
+		}
+		virtual void flush() {}
+
+		size_t print(const char* s){
+			return write(s);
+		}
+		size_t print(const __FlashStringHelper* s){
+			return write((const char*) s);
+		}
+		size_t print(char c){
+			return write((uint8_t) c);
+		}
+		size_t print(unsigned long v, int base = DEC){
+			char buf[8 * sizeof v + 1];
+			char* p = &buf[sizeof buf - 1];
+			*p = 0;
+			do {
+				uint8_t digit = v % base;
+				*--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+				v /= base;
+			} while (v);
+			return write(p);
+		}
+		size_t print(long v, int base = DEC){
+			if (base == DEC && v < 0){
+				return print('-') + print(0UL - (unsigned long) v, base);
+			}
+			return print((unsigned long) v, base);
+		}
+		size_t print(unsigned int v, int base = DEC){
+			return print((unsigned long) v, base);
+		}
+		size_t print(int v, int base = DEC){
+			return print((long) v, base);
+		}
+		size_t print(unsigned char v, int base = DEC){
+			return print((unsigned long) v, base);
+		}
+		size_t print(double v, int digits = 2){
+			char buf[32];
+			snprintf(buf, sizeof buf, "%.*f", digits, v);
+			return write(buf);
+		}
+
+		size_t println(){
+			return write("\r\n");
+		}
+		template <class T> size_t println(T v){
+			size_t n = print(v);
+			return n + println();
+		}
+		template <class T> size_t println(T v, int base){
+			size_t n = print(v, base);
+			return n + println();
+		}
+};
+
+#endif
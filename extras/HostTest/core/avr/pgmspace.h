@@ -0,0 +1,19 @@
+/*
+ * Program memory is ordinary memory on the host
+ */
+#ifndef Pgmspace_h
+#define Pgmspace_h
+
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t*) (p))
+#define pgm_read_word(p) (*(const uint16_t*) (p))
+#define pgm_read_dword(p) (*(const uint32_t*) (p))
+#define pgm_read_ptr(p) (*(void* const*) (p))
+#define strcmp_P strcmp
+#define strlen_P strlen
+#define memcpy_P memcpy
+
+#endif